@@ -0,0 +1,123 @@
+/*
+  ==============================================================================
+
+    OnsetDetectorBenchmark.cpp
+    Created: 19 Oct 2026 10:20:14am
+    Author:  Aidan Stephenson
+
+    Standalone timing harness for OnsetDetector::process. There is no build target
+    for it yet: add a Projucer console application with this file, the same
+    JuceHeader.h as the plugin (juce_audio_basics and juce_dsp are all it needs),
+    and optimisation on, then run
+
+        OnsetDetectorBenchmark [seconds of audio per run, default 60]
+
+    No figures from a JUCE build have been recorded. Numbers quoted before this
+    note came from a stand-in build with scalar loops and are unverified.
+
+  ==============================================================================
+*/
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <JuceHeader.h>
+#include "../Source/OnsetDetector.h"
+using namespace juce;
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int numRuns = 5;
+    constexpr double burstSeconds = 0.25;
+
+    // stereo noise bursts every burstSeconds with a 20ms decay, over a quiet noise floor
+    AudioBuffer<float> makeTestSignal(int numSamples)
+    {
+        AudioBuffer<float> signal(2, numSamples);
+        Random random(1234);
+        int burstLength = (int)(burstSeconds * sampleRate);
+        float decay = (float)std::exp(-1.0 / (0.02 * sampleRate));
+
+        for (int channel = 0; channel < 2; channel++)
+        {
+            float envelope = 0.f;
+            for (int i = 0; i < numSamples; i++)
+            {
+                if (i % burstLength == 0)
+                    envelope = 0.8f;
+
+                envelope *= decay;
+                signal.setSample(channel, i, (random.nextFloat() * 2.f - 1.f) * (envelope + 0.001f));
+            }
+        }
+
+        return signal;
+    }
+
+    struct Result
+    {
+        double nanosecondsPerSample;
+        int onsetsInLastSecond;
+    };
+
+    // best of numRuns, every run starts from a freshly prepared detector
+    Result run(const AudioBuffer<float>& signal, int blockSize, bool withExtra)
+    {
+        dsp::ProcessSpec spec { sampleRate, (uint32)blockSize, 2 };
+        AudioBuffer<float> block(2, blockSize), extra(2, blockSize);
+        OnsetDetector detector;
+        double best = 1.0e9;
+
+        for (int runIndex = 0; runIndex < numRuns; runIndex++)
+        {
+            detector.prepare(spec);
+            std::chrono::nanoseconds elapsed { 0 };
+
+            for (int start = 0; start + blockSize <= signal.getNumSamples(); start += blockSize)
+            {
+                for (int channel = 0; channel < 2; channel++)
+                {
+                    block.copyFrom(channel, 0, signal, channel, start, blockSize);
+                    extra.copyFrom(channel, 0, signal, 1 - channel, start, blockSize);
+                }
+
+                auto begin = std::chrono::steady_clock::now();
+                detector.process(block, withExtra ? &extra : nullptr);
+                elapsed += std::chrono::steady_clock::now() - begin;
+            }
+
+            best = jmin(best, (double)elapsed.count() / (double)signal.getNumSamples());
+        }
+
+        // a burst every burstSeconds, so about four per second when detection works
+        int onsets = 0;
+        for (int age = detector.findNewestOnset(0, (int)sampleRate); age >= 0; age = detector.findNewestOnset(age + 1, (int)sampleRate))
+            onsets++;
+
+        return { best, onsets };
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    double seconds = argc > 1 ? std::atof(argv[1]) : 60.0;
+    auto signal = makeTestSignal((int)(jmax(1.0, seconds) * sampleRate));
+
+    std::printf("OnsetDetector::process, %.0f s of stereo audio at %.0f Hz, best of %d runs\n\n", seconds, sampleRate, numRuns);
+    std::printf("%8s %10s %12s %14s %8s\n", "block", "extra", "ns/sample", "x realtime", "onsets/s");
+
+    for (int blockSize : { 32, 64, 128, 256, 512, 1024, 2048 })
+    {
+        for (bool withExtra : { false, true })
+        {
+            auto result = run(signal, blockSize, withExtra);
+            double realtime = 1.0e9 / (result.nanosecondsPerSample * sampleRate);
+
+            std::printf("%8d %10s %12.2f %14.0f %8d\n", blockSize, withExtra ? "sidechain" : "-",
+                        result.nanosecondsPerSample, realtime, result.onsetsInLastSecond);
+        }
+    }
+
+    return 0;
+}
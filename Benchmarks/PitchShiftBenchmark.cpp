@@ -0,0 +1,157 @@
+/*
+  ==============================================================================
+
+    PitchShiftBenchmark.cpp
+    Created: 19 Oct 2026 11:42:37am
+    Author:  Aidan Stephenson
+
+    Standalone timing harness comparing the per-channel cost of
+    PitchShiftProcessor::process with the grain pitch path, GrainProcessor::process,
+    at the same pitch shift. There is no build target for it yet: add a Projucer
+    console application with this file, the same JuceHeader.h as the plugin, and
+    optimisation on, then run
+
+        PitchShiftBenchmark [semitones, default 7] [seconds of audio per run, default 20]
+
+    No figures from a JUCE build have been recorded. Numbers quoted before this
+    note came from a stand-in build and are unverified.
+
+    Only the process() calls are timed. The grain history is filled outside the
+    timed region, as the chain does that once for every module.
+
+  ==============================================================================
+*/
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <JuceHeader.h>
+#include "../Source/CircularBuffer.h"
+#include "../Source/GrainProcessor.h"
+#include "../Source/PitchShiftProcessor.h"
+#include "../Source/PresetBank.h"
+using namespace juce;
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 256;
+    constexpr int numRuns = 3;
+
+    // every parameter the two modules read, held outside any value tree
+    ParameterState makeParameters(float semitones, int quality)
+    {
+        StringArray ids { PARAMS::GrainBypass, PARAMS::GrainMix, PARAMS::GrainSize, PARAMS::GrainDensity, PARAMS::GrainPitch,
+                          PARAMS::GrainEnvelope, PARAMS::GrainFreeze, PARAMS::GrainDelay, PARAMS::GrainStereo, PARAMS::GrainOnset,
+                          PARAMS::GrainOnsetMode, PARAMS::PitchBypass, PARAMS::PitchMix, PARAMS::PitchShift, PARAMS::PitchFormant,
+                          PARAMS::PitchKeepFormants, PARAMS::PitchQuality, PARAMS::PitchShimmer, PARAMS::PitchShimmerFeedback,
+                          PARAMS::PitchShimmerSize };
+
+        float values[] { 0.f, 100.f, 50.f, 10.f, semitones,
+                         0.f, 0.f, 0.f, 0.f, 0.f,
+                         0.f, 0.f, 100.f, semitones, 0.f,
+                         0.f, (float)quality, 0.f, 50.f,
+                         70.f };
+
+        ParameterState params;
+        params.prepare(ids);
+
+        for (int i = 0; i < ids.size(); i++)
+            params.set(i, values[i]);
+
+        return params;
+    }
+
+    AudioBuffer<float> makeTestSignal(int numSamples)
+    {
+        AudioBuffer<float> signal(2, numSamples);
+        Random random(1234);
+
+        // a chord with a little noise, so the phase vocoder has more than one partial to track
+        for (int channel = 0; channel < 2; channel++)
+            for (int i = 0; i < numSamples; i++)
+            {
+                double t = i / sampleRate;
+                float chord = (float)(std::sin(2.0 * MathConstants<double>::pi * 220.0 * t)
+                                    + 0.5 * std::sin(2.0 * MathConstants<double>::pi * 277.2 * t)
+                                    + 0.25 * std::sin(2.0 * MathConstants<double>::pi * 329.6 * t));
+                signal.setSample(channel, i, 0.25f * chord + 0.01f * (random.nextFloat() * 2.f - 1.f));
+            }
+
+        return signal;
+    }
+
+    // best of numRuns, in ns per sample per channel
+    template <typename Module>
+    double time(Module& module, ParameterState& params, const AudioBuffer<float>& signal, int numChannels)
+    {
+        dsp::ProcessSpec spec { sampleRate, (uint32)blockSize, (uint32)numChannels };
+        AudioBuffer<float> block(numChannels, blockSize);
+        CircularBuffer history;
+        double best = 1.0e9;
+
+        for (int runIndex = 0; runIndex < numRuns; runIndex++)
+        {
+            module.applyLatencySettings(params);
+            module.prepare(spec);
+            module.update(params);
+            history.prepare(spec);
+            history.clearBuffer();
+            history.writePos = 0;
+
+            std::chrono::nanoseconds elapsed { 0 };
+
+            for (int start = 0; start + blockSize <= signal.getNumSamples(); start += blockSize)
+            {
+                for (int channel = 0; channel < numChannels; channel++)
+                    block.copyFrom(channel, 0, signal, channel, start, blockSize);
+
+                history.fillBuffer(block);
+
+                auto begin = std::chrono::steady_clock::now();
+                module.process(block, history, 0);
+                elapsed += std::chrono::steady_clock::now() - begin;
+            }
+
+            best = jmin(best, (double)elapsed.count() / ((double)signal.getNumSamples() * numChannels));
+        }
+
+        return best;
+    }
+
+    void report(const char* name, int numChannels, double nanoseconds)
+    {
+        std::printf("%-28s %9d %14.1f %12.0f\n", name, numChannels, nanoseconds, 1.0e9 / (nanoseconds * sampleRate));
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    float semitones = argc > 1 ? (float)std::atof(argv[1]) : 7.f;
+    double seconds = argc > 2 ? std::atof(argv[2]) : 20.0;
+    auto signal = makeTestSignal((int)(jmax(1.0, seconds) * sampleRate));
+
+    std::printf("%+.1f semitones, %.0f s at %.0f Hz, %d sample blocks, best of %d runs\n\n", semitones, seconds, sampleRate, blockSize, numRuns);
+    std::printf("%-28s %9s %14s %12s\n", "module", "channels", "ns/sample/ch", "x realtime");
+
+    // the grain path always works on a stereo pair
+    {
+        auto params = makeParameters(std::round(semitones), 0);
+        GrainProcessor grain;
+        report("Grain (50ms, 10/s)", 2, time(grain, params, signal, 2));
+    }
+
+    const char* names[] { "Phase vocoder 1024", "Phase vocoder 2048", "Phase vocoder 4096" };
+
+    for (int quality = 0; quality < 3; quality++)
+    {
+        for (int numChannels : { 1, 2 })
+        {
+            auto params = makeParameters(semitones, quality);
+            auto pitch = std::make_unique<PitchShiftProcessor>();
+            report(names[quality], numChannels, time(*pitch, params, signal, numChannels));
+        }
+    }
+
+    return 0;
+}
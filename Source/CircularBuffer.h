@@ -10,11 +10,15 @@
 
 #pragma once
 
+#include "OnsetDetector.h"
 using namespace juce;
 
 class CircularBuffer
 {
 public:
+    // input is written into the buffer at -20dB, readers apply makeupGain to restore level
+    static constexpr float writeGain = 0.1f;
+    static constexpr float makeupGain = 1.f / writeGain;
     
     void prepare(dsp::ProcessSpec& spec)
     {
@@ -22,9 +26,10 @@ public:
         int numChannels = spec.numChannels;
         
         circularBuffer.setSize(numChannels, (int)bufferSize);
+        onsets.prepare(spec);
     }
     
-    int getSize()
+    int getSize() const
     {
         int size = circularBuffer.getNumSamples();
         return size;
@@ -33,6 +38,30 @@ public:
     void clearBuffer()
     {
         circularBuffer.clear();
+        onsets.reset();
+    }
+    
+    // transients detected in the input as it was written, see OnsetDetector
+    const OnsetDetector& getOnsets() const
+    {
+        return onsets;
+    }
+    
+    const AudioBuffer<float>& getBuffer() const
+    {
+        return circularBuffer;
+    }
+    
+    // snapshot must match the current size, callers check before restoring
+    void restore(const AudioBuffer<float>& snapshot, int newWritePos)
+    {
+        int numChannels = jmin(circularBuffer.getNumChannels(), snapshot.getNumChannels());
+        
+        for (int channel = 0; channel < numChannels; channel++)
+            circularBuffer.copyFrom(channel, 0, snapshot, channel, 0, circularBuffer.getNumSamples());
+        
+        writePos = newWritePos % circularBuffer.getNumSamples();
+        onsets.reset();
     }
     
     float read(int channel, int index)
@@ -40,21 +69,50 @@ public:
         return circularBuffer.getSample(channel, index);
     }
     
-    void fillBuffer(AudioBuffer<float>& buffer)
+    // extra is summed in on top of buffer, e.g. a sidechain granulated alongside the main input
+    void fillBuffer(const AudioBuffer<float>& buffer, const AudioBuffer<float>* extra = nullptr)
+    {
+        int bufferSize = buffer.getNumSamples();
+        int circularBufferSize = circularBuffer.getNumSamples();
+        
+        writeBlock(buffer, false);
+        
+        if (extra != nullptr)
+            writeBlock(*extra, true);
+        
+        //DBG("writePos = " << writePos);
+        //DBG("circularBufferSize = " << circularBufferSize);
+        //DBG("bufferSize = " << bufferSize);
+        
+        writePos += bufferSize;
+        writePos = writePos % circularBufferSize;
+        
+        onsets.process(buffer, extra);
+    }
+    
+    int writePos = { 0 };
+    
+private:
+    void writeBlock(const AudioBuffer<float>& buffer, bool addToExisting)
     {
         int bufferSize = buffer.getNumSamples();
         int circularBufferSize = circularBuffer.getNumSamples();
         
         int numChannels = circularBuffer.getNumChannels();
+        int numSourceChannels = buffer.getNumChannels();
+        
+        if (numSourceChannels == 0)
+            return;
         
         for (int channel = 0; channel < numChannels; channel++)
         {
-            auto* input = buffer.getReadPointer(channel);
+            // a mono source is written to every channel
+            auto* input = buffer.getReadPointer(jmin(channel, numSourceChannels - 1));
             
             if (circularBufferSize > bufferSize + writePos)
             {
                 // enough space in circularBuffer for input buffer -> no need to wrap
-                circularBuffer.copyFromWithRamp(channel, writePos, input, bufferSize, 0.1f, 0.1f);
+                write(channel, writePos, input, bufferSize, addToExisting);
             }
             else
             {
@@ -62,21 +120,20 @@ public:
                 int preWrapSamples = circularBufferSize - writePos;
                 int postWrapSamples = bufferSize - preWrapSamples;
                 
-                circularBuffer.copyFromWithRamp(channel, writePos, input, preWrapSamples, 0.1f, 0.1f);
-                circularBuffer.copyFromWithRamp(channel, 0, input, postWrapSamples, 0.1f, 0.1f);
+                write(channel, writePos, input, preWrapSamples, addToExisting);
+                write(channel, 0, input + preWrapSamples, postWrapSamples, addToExisting);
             }
         }
-        
-        //DBG("writePos = " << writePos);
-        //DBG("circularBufferSize = " << circularBufferSize);
-        //DBG("bufferSize = " << bufferSize);
-        
-        writePos += bufferSize;
-        writePos = writePos % circularBufferSize;
     }
     
-    int writePos = { 0 };
+    void write(int channel, int startSample, const float* input, int numSamples, bool addToExisting)
+    {
+        if (addToExisting)
+            circularBuffer.addFromWithRamp(channel, startSample, input, numSamples, writeGain, writeGain);
+        else
+            circularBuffer.copyFromWithRamp(channel, startSample, input, numSamples, writeGain, writeGain);
+    }
     
-private:
     AudioBuffer<float> circularBuffer;
+    OnsetDetector onsets;
 };
@@ -0,0 +1,172 @@
+/*
+  ==============================================================================
+
+    DelayProcessor.h
+    Created: 18 Oct 2026 10:40:12am
+    Author:  Aidan Stephenson
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "CircularBuffer.h"
+#include "ParameterIDs.h"
+using namespace juce;
+
+class DelayProcessor
+{
+public:
+    DelayProcessor() {}
+
+    void prepare(dsp::ProcessSpec& spec)
+    {
+        sampleRate = spec.sampleRate;
+        numChannels = spec.numChannels;
+
+        // one echo per channel, long enough for the longest delay time
+        echoBuffer.setSize(2, (int)(maxDelayMs * sampleRate / 1000.0) + 1);
+        echoBuffer.clear();
+        echoPos = 0;
+
+        for (auto& mixer : mixerBlend)
+            mixer.reset(sampleRate, 0.02);
+
+        // start settled in whichever state the bypass parameter was left
+        fadingOut = bypass;
+        for (auto& power : powerBlend)
+        {
+            power.reset(sampleRate, bypassFadeSeconds);
+            power.setCurrentAndTargetValue(bypass ? 0.f : 1.f);
+        }
+    }
+
+    void addParams(AudioProcessorParameterGroup& params)
+    {
+        params.addChild(std::make_unique<AudioParameterBool>(ParameterID(PARAMS::DelayBypass, 1), "Delay Bypass", true));
+        params.addChild(std::make_unique<AudioParameterFloat>(ParameterID(PARAMS::DelayMix, 1), "Delay Mix", NormalisableRange<float>(0.f, 100.f, 1.f), 30.f));
+        params.addChild(std::make_unique<AudioParameterFloat>(ParameterID(PARAMS::DelayTime, 1), "Delay Time", NormalisableRange<float>(10.f, maxDelayMs, 0.1f, 0.5f), 250.f));
+        params.addChild(std::make_unique<AudioParameterFloat>(ParameterID(PARAMS::DelayFeedback, 1), "Delay Feedback", NormalisableRange<float>(0.f, 90.f, 1.f), 40.f));
+    }
+
+    static String getName()
+    {
+        return "Delay";
+    }
+
+    // audio thread: true once the echoes have faded out, the chain then skips us
+    bool isBypassed() const
+    {
+        return bypass;
+    }
+
+    int getLatencySamples() const
+    {
+        return 0;
+    }
+
+    // no parameter here changes the latency
+    template <typename ParameterSource>
+    void applyLatencySettings(ParameterSource&) {}
+
+    // message thread: repeats keep going until feedback has taken them down 60dB
+    template <typename ParameterSource>
+    double getTailSeconds(ParameterSource& params) const
+    {
+        if ((bool)params.getRawParameterValue(PARAMS::DelayBypass)->load())
+            return 0.0;
+
+        double time = params.getRawParameterValue(PARAMS::DelayTime)->load() / 1000.0;
+        double gain = params.getRawParameterValue(PARAMS::DelayFeedback)->load() * 0.01;
+        double repeats = gain > 0.0 ? std::log(0.001) / std::log(gain) : 0.0;
+
+        return time * (1.0 + std::ceil(repeats));
+    }
+
+    template <typename ParameterSource>
+    bool update(ParameterSource& params)
+    {
+        fadingOut = (bool)params.getRawParameterValue(PARAMS::DelayBypass)->load();
+
+        if (bypass && !fadingOut)
+        {
+            // the echo buffer stopped with whatever it held, start the repeats from silence
+            reset();
+            bypass = false;
+        }
+
+        for (auto& power : powerBlend)
+            power.setTargetValue(fadingOut ? 0.f : 1.f);
+
+        float mix = params.getRawParameterValue(PARAMS::DelayMix)->load() * 0.01f;
+        float time = params.getRawParameterValue(PARAMS::DelayTime)->load();
+
+        for (auto& mixer : mixerBlend)
+            mixer.setTargetValue(mix);
+
+        // time parameter is in miliseconds, convert from ms to samples
+        delaySamples = jlimit(1, echoBuffer.getNumSamples() - 1, (int)((time * sampleRate) / 1000.f));
+        feedback = params.getRawParameterValue(PARAMS::DelayFeedback)->load() * 0.01f;
+
+        return true;
+    }
+
+    void reset()
+    {
+        for (auto& mixer : mixerBlend)
+            mixer.setCurrentAndTargetValue(mixer.getTargetValue());
+
+        echoBuffer.clear();
+    }
+
+    // the echoes are fed from the block we are given, the shared history is not used as Freeze
+    // holds it still. Each repeat is the input plus the previous echo fed back through our own
+    // buffer, so the tail decays by feedback per repeat:
+    //     echo[n] = input[n - delay] + feedback * echo[n - delay]
+    void process(juce::AudioBuffer<float>& buffer, CircularBuffer&, int)
+    {
+        auto numSamples = buffer.getNumSamples();
+        const int channels = jmin(buffer.getNumChannels(), numChannels, echoBuffer.getNumChannels());
+
+        const int echoSize = echoBuffer.getNumSamples();
+
+        for (int i = 0; i < numSamples; i++)
+        {
+            // the input is faded in with the output, so the first repeat doesn't start with a step
+            float power = powerBlend[0].getNextValue();
+            float wet = mixerBlend[0].getNextValue() * power;
+            float dry = 1.f - wet;
+
+            int echoReadPos = (echoPos - delaySamples + echoSize) % echoSize;
+
+            for (int channel = 0; channel < channels; channel++)
+            {
+                auto* channelData = buffer.getWritePointer(channel);
+                auto* echoData = echoBuffer.getWritePointer(channel);
+
+                float echo = echoData[echoReadPos];
+                echoData[echoPos] = power * channelData[i] + feedback * echo;
+
+                channelData[i] = (dry * channelData[i]) + (wet * echo);
+            }
+
+            echoPos = (echoPos + 1) % echoSize;
+        }
+
+        // fully faded out, from the next block the chain passes the buffer straight through
+        if (fadingOut && powerBlend[0].getCurrentValue() <= 0.f)
+            bypass = true;
+    }
+
+private:
+    static constexpr float maxDelayMs = 1000.f;
+    static constexpr double bypassFadeSeconds = 0.01;
+
+    std::array<juce::LinearSmoothedValue<float>, 2> powerBlend, mixerBlend;
+    AudioBuffer<float> echoBuffer;
+
+    float sampleRate = 44100.f, feedback = 0.f;
+    int numChannels = 2, delaySamples = 1, echoPos = 0;
+    bool bypass = true, fadingOut = true;
+};
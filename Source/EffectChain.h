@@ -0,0 +1,422 @@
+/*
+  ==============================================================================
+
+    EffectChain.h
+    Created: 18 Oct 2026 11:05:48am
+    Author:  Aidan Stephenson
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <array>
+#include <tuple>
+#include <utility>
+#include <JuceHeader.h>
+#include "CircularBuffer.h"
+#include "ParameterIDs.h"
+using namespace juce;
+
+inline StringArray historySources =
+{
+    "Main",
+    "Sidechain",
+    "Main + Sidechain",
+};
+
+enum historySourceIndex
+{
+    SourceMain = 0,
+    SourceSidechain = 1,
+    SourceBoth = 2,
+};
+
+namespace ChainOrders
+{
+    constexpr size_t factorial(size_t n)
+    {
+        return n <= 1 ? 1 : n * factorial(n - 1);
+    }
+
+    // every permutation of the module indices in lexicographic order, so the declared
+    // order comes first. Done by hand as std::next_permutation is not constexpr in C++17.
+    template <size_t NumModules>
+    constexpr std::array<std::array<size_t, NumModules>, factorial(NumModules)> makePermutations()
+    {
+        std::array<std::array<size_t, NumModules>, factorial(NumModules)> table {};
+        std::array<size_t, NumModules> order {};
+
+        for (size_t slot = 0; slot < NumModules; slot++)
+            order[slot] = slot;
+
+        for (size_t permutation = 0; permutation < table.size(); permutation++)
+        {
+            table[permutation] = order;
+
+            // rightmost slot that is smaller than its neighbour
+            size_t pivot = NumModules - 1;
+            while (pivot > 0 && order[pivot - 1] >= order[pivot])
+                pivot--;
+
+            if (pivot == 0)
+                break;
+
+            // swap it with the rightmost larger slot, then reverse the tail
+            size_t swapWith = NumModules - 1;
+            while (order[swapWith] <= order[pivot - 1])
+                swapWith--;
+
+            size_t held = order[pivot - 1];
+            order[pivot - 1] = order[swapWith];
+            order[swapWith] = held;
+
+            for (size_t low = pivot, high = NumModules - 1; low < high; low++, high--)
+            {
+                held = order[low];
+                order[low] = order[high];
+                order[high] = held;
+            }
+        }
+
+        return table;
+    }
+}
+
+/*
+    Compile-time signal chain. Every module type in Modules... provides
+
+        void prepare(dsp::ProcessSpec&);
+        void addParams(AudioProcessorParameterGroup&);
+        template <typename ParameterSource> bool update(ParameterSource&);
+        template <typename ParameterSource> void applyLatencySettings(ParameterSource&);
+        template <typename ParameterSource> double getTailSeconds(ParameterSource&) const;
+        void process(AudioBuffer<float>&, CircularBuffer& history, int upstreamLatency);
+        void reset();
+        bool isBypassed() const;
+        int getLatencySamples() const;
+        static String getName();
+
+    Modules are held by value and called directly, so there is no virtual dispatch
+    and each call can be inlined. All modules process the same buffer in place and
+    read input history from one shared CircularBuffer that the chain fills once per
+    block, so history-based modules tap the chain input rather than each other. Each
+    module is told how far the modules ahead of it in the current order have delayed
+    the buffer, and reads that much further back in the history to stay aligned.
+
+    Latency is fixed by parameters that are only applied on the message thread, bypass
+    among them, so automation never changes what the chain reports to the host. A module
+    that is bypassed reports no latency and is skipped altogether; it fades its output
+    over to the input first, so isBypassed only turns true once that fade has finished.
+
+    The history can be fed from an optional sidechain instead of, or as well as, the
+    main input. The main input then passes through to the modules as the dry signal,
+    ducked by the sidechain level if SidechainDuck is up.
+
+    Freeze stops the history writes, so the grains keep playing the frozen audio. The
+    frozen history is what the plugin state saves: the audio thread only marks it held
+    once it has stopped writing, and the message thread only copies it while it is held.
+*/
+template <typename... Modules>
+class EffectChain
+{
+public:
+    static constexpr size_t numModules = sizeof...(Modules);
+    static_assert(numModules > 0, "EffectChain needs at least one module");
+
+    // every order is precompiled, switching order on the audio thread is just an index change
+    static constexpr size_t numOrders = ChainOrders::factorial(numModules);
+    using Order = std::array<size_t, numModules>;
+
+    EffectChain() {}
+
+    void prepare(dsp::ProcessSpec& spec)
+    {
+        sampleRate = spec.sampleRate;
+        duckEnvelope = 0.f;
+        duckGain = 1.f;
+
+        history.prepare(spec);
+        history.clearBuffer();
+        history.writePos = 0;
+        historyHeld.store(false);
+        applyPendingHistory();
+
+        forEachModule([&spec](auto& module) { module.prepare(spec); });
+    }
+
+    void addParams(AudioProcessorParameterGroup& params)
+    {
+        StringArray orderNames;
+        for (const auto& order : orders)
+        {
+            StringArray names;
+            for (auto slot : order)
+                names.add(moduleNames()[slot]);
+
+            orderNames.add(names.joinIntoString(" > "));
+        }
+
+        params.addChild(std::make_unique<AudioParameterChoice>(ParameterID(PARAMS::ChainOrder, 1), "Chain Order", orderNames, 0));
+        params.addChild(std::make_unique<AudioParameterChoice>(ParameterID(PARAMS::HistorySource, 1), "Source", historySources, SourceMain));
+        params.addChild(std::make_unique<AudioParameterFloat>(ParameterID(PARAMS::SidechainDuck, 1), "Sidechain Duck", NormalisableRange<float>(0.f, 100.f, 1.f), 0.f));
+
+        forEachModule([&params](auto& module) { module.addParams(params); });
+    }
+
+    // params is the value tree state, or a ParameterState holding morphed values
+    template <typename ParameterSource>
+    void update(ParameterSource& params)
+    {
+        currentOrder = jlimit(0, (int)numOrders - 1, (int)params.getRawParameterValue(PARAMS::ChainOrder)->load());
+        historySource = (int)params.getRawParameterValue(PARAMS::HistorySource)->load();
+        duckAmount = params.getRawParameterValue(PARAMS::SidechainDuck)->load() * 0.01f;
+        historyFrozen = (bool)params.getRawParameterValue(PARAMS::GrainFreeze)->load();
+
+        forEachModule([&params](auto& module) { module.update(params); });
+    }
+
+    // message thread: picks up the parameters that set latency, call getLatencySamples afterwards
+    template <typename ParameterSource>
+    void applyLatencySettings(ParameterSource& params)
+    {
+        forEachModule([&params](auto& module) { module.applyLatencySettings(params); });
+    }
+
+    void reset()
+    {
+        history.clearBuffer();
+        forEachModule([](auto& module) { module.reset(); });
+    }
+
+    // sidechain refers straight into the host's buffer, pass nullptr when the bus is disabled
+    void process(AudioBuffer<float>& buffer, const AudioBuffer<float>* sidechain = nullptr)
+    {
+        if (restoreState.load() == RestorePending && releaseHistory())
+            applyPendingHistory();
+
+        bool useSidechain = sidechain != nullptr && sidechain->getNumChannels() > 0 && historySource != SourceMain;
+
+        // a frozen history stays as it is, and so does one the message thread is still copying
+        if (!historyFrozen && releaseHistory())
+        {
+            if (!useSidechain)
+                history.fillBuffer(buffer);
+            else if (historySource == SourceSidechain)
+                history.fillBuffer(*sidechain);
+            else
+                history.fillBuffer(buffer, sidechain);
+        }
+        else
+        {
+            historyHeld.store(true);
+        }
+
+        if (useSidechain)
+            duckMainInput(buffer, *sidechain);
+
+        int upstreamLatency = 0;
+        for (auto slot : orders[currentOrder])
+            processSlot(slot, buffer, upstreamLatency, std::index_sequence_for<Modules...>{});
+    }
+
+    // modules run in series, so the chain latency is the sum of every active module's latency
+    int getLatencySamples()
+    {
+        int latency = 0;
+        forEachModule([&latency](auto& module) { latency += module.getLatencySamples(); });
+
+        return latency;
+    }
+
+    // message thread: modules run in series, so each tail rings on through the ones after it
+    template <typename ParameterSource>
+    double getTailLengthSeconds(ParameterSource& params) const
+    {
+        double tail = 0.0;
+        forEachModule([&tail, &params](const auto& module) { tail += module.getTailSeconds(params); });
+
+        return tail;
+    }
+
+    template <typename Module>
+    Module& get()
+    {
+        return std::get<Module>(modules);
+    }
+
+    CircularBuffer& getHistory()
+    {
+        return history;
+    }
+
+    // message thread: the frozen history, or a restore the audio thread hasn't picked up yet.
+    // Writes a single false when there is nothing held to save
+    void writeHistory(OutputStream& stream)
+    {
+        if (restoreState.load() != RestoreIdle)
+        {
+            writeHistory(stream, pendingHistory, pendingWritePos);
+            return;
+        }
+
+        // if the audio thread lets go of the history at the same time, it sees this and holds on
+        historyReading.store(true);
+
+        if (historyHeld.load())
+            writeHistory(stream, history.getBuffer(), history.writePos);
+        else
+            stream.writeBool(false);
+
+        historyReading.store(false);
+    }
+
+    // message thread: the history is copied in at the start of the next block, or dropped if it
+    // was prepared at a different size
+    void readHistory(InputStream& stream)
+    {
+        if (!stream.readBool())
+            return;
+
+        int numChannels = stream.readCompressedInt();
+        int numSamples = stream.readCompressedInt();
+        int writePos = stream.readCompressedInt();
+
+        if (numChannels <= 0 || numSamples <= 0 || writePos < 0)
+            return;
+
+        // take back a restore that hasn't started, or wait out the copy of one that has
+        int expected = RestorePending;
+        while (!restoreState.compare_exchange_weak(expected, RestoreIdle) && expected != RestoreIdle)
+        {
+            Thread::yield();
+            expected = RestorePending;
+        }
+
+        pendingHistory.setSize(numChannels, numSamples, false, false, true);
+        for (int channel = 0; channel < numChannels; channel++)
+            stream.read(pendingHistory.getWritePointer(channel), (int)(sizeof(float) * (size_t)numSamples));
+
+        pendingWritePos = writePos;
+        restoreState.store(RestorePending);
+    }
+
+private:
+    static StringArray moduleNames()
+    {
+        return { Modules::getName()... };
+    }
+
+    enum RestoreState
+    {
+        RestoreIdle = 0,
+        RestorePending = 1,
+        RestoreApplying = 2,
+    };
+
+    static void writeHistory(OutputStream& stream, const AudioBuffer<float>& buffer, int writePos)
+    {
+        stream.writeBool(true);
+        stream.writeCompressedInt(buffer.getNumChannels());
+        stream.writeCompressedInt(buffer.getNumSamples());
+        stream.writeCompressedInt(writePos);
+
+        for (int channel = 0; channel < buffer.getNumChannels(); channel++)
+            stream.write(buffer.getReadPointer(channel), sizeof(float) * (size_t)buffer.getNumSamples());
+    }
+
+    // audio thread: true when the history may be written. historyHeld is dropped before
+    // historyReading is checked, and the message thread does the reverse, so at least one of
+    // the two sees the other and a copy never overlaps a write
+    bool releaseHistory()
+    {
+        if (!historyHeld.load())
+            return true;
+
+        historyHeld.store(false);
+
+        if (!historyReading.load())
+            return true;
+
+        historyHeld.store(true);
+        return false;
+    }
+
+    void applyPendingHistory()
+    {
+        int expected = RestorePending;
+        if (!restoreState.compare_exchange_strong(expected, RestoreApplying))
+            return;
+
+        if (pendingHistory.getNumSamples() == history.getSize())
+            history.restore(pendingHistory, pendingWritePos);
+
+        restoreState.store(RestoreIdle);
+    }
+
+    void duckMainInput(AudioBuffer<float>& buffer, const AudioBuffer<float>& sidechain)
+    {
+        int numSamples = buffer.getNumSamples();
+
+        // block-rate peak follower, instant attack and duckReleaseSeconds release
+        float level = 0.f;
+        for (int channel = 0; channel < sidechain.getNumChannels(); channel++)
+            level = jmax(level, sidechain.getMagnitude(channel, 0, numSamples));
+
+        float release = (float)std::exp(-numSamples / (duckReleaseSeconds * sampleRate));
+        duckEnvelope = jmax(level, duckEnvelope * release);
+
+        float targetGain = 1.f - duckAmount * jmin(1.f, duckEnvelope);
+        if (targetGain != 1.f || duckGain != 1.f)
+            buffer.applyGainRamp(0, numSamples, duckGain, targetGain);
+
+        duckGain = targetGain;
+    }
+
+    template <typename Function>
+    void forEachModule(Function&& function)
+    {
+        std::apply([&function](auto&... module) { (function(module), ...); }, modules);
+    }
+
+    template <typename Function>
+    void forEachModule(Function&& function) const
+    {
+        std::apply([&function](const auto&... module) { (function(module), ...); }, modules);
+    }
+
+    // expands to a chain of compares against compile-time indices, only the matching module runs
+    template <size_t... Is>
+    void processSlot(size_t slot, AudioBuffer<float>& buffer, int& upstreamLatency, std::index_sequence<Is...>)
+    {
+        ((slot == Is ? processModule(std::get<Is>(modules), buffer, upstreamLatency) : void()), ...);
+    }
+
+    template <typename Module>
+    void processModule(Module& module, AudioBuffer<float>& buffer, int& upstreamLatency)
+    {
+        // bypassed modules leave the buffer as it is
+        if (module.isBypassed())
+            return;
+
+        module.process(buffer, history, upstreamLatency);
+        upstreamLatency += module.getLatencySamples();
+    }
+
+    static constexpr std::array<Order, numOrders> orders = ChainOrders::makePermutations<numModules>();
+
+    std::tuple<Modules...> modules;
+    CircularBuffer history;
+    int currentOrder = 0;
+
+    static constexpr double duckReleaseSeconds = 0.15;
+    double sampleRate = 44100.0;
+    int historySource = SourceMain;
+    float duckAmount = 0.f, duckEnvelope = 0.f, duckGain = 1.f;
+    bool historyFrozen = false;
+
+    AudioBuffer<float> pendingHistory;
+    int pendingWritePos = 0;
+    std::atomic<int> restoreState { RestoreIdle };
+    std::atomic<bool> historyHeld { false }, historyReading { false };
+};
@@ -13,25 +13,9 @@
 #include <vector>
 #include <JuceHeader.h>
 #include "CircularBuffer.h"
+#include "ParameterIDs.h"
 using namespace juce;
 
-namespace PARAMS
-{
-    #define PARAMETER_ID(str) constexpr const char* str { #str };
-
-    PARAMETER_ID(GrainMix)
-    PARAMETER_ID(GrainBypass)
-    PARAMETER_ID(GrainSize)
-    PARAMETER_ID(GrainDensity)
-    PARAMETER_ID(GrainPitch)
-    PARAMETER_ID(GrainEnvelope)
-    PARAMETER_ID(GrainFreeze)
-    PARAMETER_ID(GrainDelay)
-    PARAMETER_ID(GrainFeedback)
-    PARAMETER_ID(GrainStereo)
-    PARAMETER_ID(GrainOnset)
-}
-
 struct Grain
 {
     double currentPos;
@@ -56,20 +40,53 @@ enum envelopeIndex
     CosineBell = 2,
 };
 
+inline StringArray onsetModes =
+{
+    "Off",
+    "Snap",
+    "Avoid",
+};
+
+enum onsetModeIndex
+{
+    OnsetOff = 0,
+    OnsetSnap = 1,
+    OnsetAvoid = 2,
+};
+
 class GrainProcessor
 {
 public:
-    GrainProcessor() {}
+    GrainProcessor()
+    {
+        randomSpawn.setSeed(randomSeed.load());
+    }
     
     void prepare(dsp::ProcessSpec& spec)
     {
         sampleRate = spec.sampleRate;
         numChannels = spec.numChannels;
-        circularBuffer.prepare(spec);
+        minReadOffset = jmax(1, (int)spec.maximumBlockSize);
         grainPool.reserve(20);
+        
+        int maxReadOffset = jmax(minReadOffset, (int)((maxReadOffsetMs * sampleRate) / 1000.0));
+        dryBuffer.setSize(2, maxReadOffset + 1);
+        dryBuffer.clear();
+        dryWritePos = 0;
+        latencySamples.store(jlimit(minReadOffset, maxReadOffset, latencySamples.load()));
+        readOffset = latencySamples.load();
         outputGain.prepare(spec);
         outputGain.setGainDecibels(20.f);
         
+        // start settled in whichever state the bypass parameter was left
+        bypass = bypassRequested.load();
+        holdRemaining = 0;
+        for (auto& power : powerBlend)
+        {
+            power.reset(sampleRate, bypassFadeSeconds);
+            power.setCurrentAndTargetValue(bypass ? 0.f : 1.f);
+        }
+        
         const int numPoints = 1024;
         parabolicEnvelope.initialise ([numPoints](float index) {
                 // Map the incoming index (0 to 1023) back to 0.0-1.0 for the cos math
@@ -98,22 +115,94 @@ public:
     
     void addParams(AudioProcessorParameterGroup& params)
     {
-        params.addChild(std::make_unique<AudioParameterBool>(ParameterID(PARAMS::GrainBypass, 1), "Bypass", false));
+        params.addChild(std::make_unique<AudioParameterBool>(ParameterID(PARAMS::GrainBypass, 1), "Bypass", false,
+                                                             AudioParameterBoolAttributes().withAutomatable(false)));
         params.addChild(std::make_unique<AudioParameterFloat>(ParameterID(PARAMS::GrainMix, 1), "Mix", NormalisableRange<float>(0.f, 100.f, 1.f), 50.f));
         params.addChild(std::make_unique<AudioParameterFloat>(ParameterID(PARAMS::GrainSize, 1), "Size", NormalisableRange<float>(20.f, 100.f, 0.1f, 1.1f), 50.f));
         params.addChild(std::make_unique<AudioParameterFloat>(ParameterID(PARAMS::GrainDensity, 1), "Density", NormalisableRange<float>(2.f, 20.f, 0.01f), 10.f));
+        params.addChild(std::make_unique<AudioParameterFloat>(ParameterID(PARAMS::GrainDelay, 1), "Read Offset", NormalisableRange<float>(0.f, maxReadOffsetMs, 0.1f, 0.5f), 0.f,
+                                                                  AudioParameterFloatAttributes().withAutomatable(false)));
         
         params.addChild(std::make_unique<AudioParameterFloat>(ParameterID(PARAMS::GrainPitch, 1), "Pitch", NormalisableRange<float>(-12.f, 12.f, 1.f), 0.f));
         params.addChild(std::make_unique<AudioParameterChoice>(ParameterID(PARAMS::GrainEnvelope, 1), "Envelope", envelopeTypes, Parabolic));
         params.addChild(std::make_unique<AudioParameterFloat>(ParameterID(PARAMS::GrainStereo, 1), "Stereo", NormalisableRange<float>(0.f, 100.f, 1.f), 0.f));
         params.addChild(std::make_unique<AudioParameterFloat>(ParameterID(PARAMS::GrainOnset, 1), "Onset Spray", NormalisableRange<float>(0.f, 100.f, 1.f), 0.f));
+        params.addChild(std::make_unique<AudioParameterChoice>(ParameterID(PARAMS::GrainOnsetMode, 1), "Onset Mode", onsetModes, OnsetOff));
         
         params.addChild(std::make_unique<AudioParameterBool>(ParameterID(PARAMS::GrainFreeze, 1), "Freeze", false));
     }
     
-    bool update(AudioProcessorValueTreeState& params)
+    static String getName()
+    {
+        return "Grain";
+    }
+    
+    // audio thread: true once the output has faded over to the input, the chain then skips us
+    bool isBypassed() const
+    {
+        return bypass;
+    }
+    
+    // the dry signal is delayed by the read offset so it stays aligned with the grains,
+    // bypassed there is no delay at all
+    int getLatencySamples() const
+    {
+        return bypassRequested.load() ? 0 : latencySamples.load();
+    }
+    
+    // message thread: Read Offset and Bypass set the latency, so they are not automatable and
+    // never read in update
+    template <typename ParameterSource>
+    void applyLatencySettings(ParameterSource& params)
+    {
+        setReadOffset(params.getRawParameterValue(PARAMS::GrainDelay)->load());
+        bypassRequested.store((bool)params.getRawParameterValue(PARAMS::GrainBypass)->load());
+    }
+    
+    // message thread: the new seed is picked up by the audio thread on the next update
+    void setSeed(int64 seed)
+    {
+        randomSeed.store(seed);
+        reseedPending.store(true);
+    }
+    
+    int64 getSeed() const
+    {
+        return randomSeed.load();
+    }
+    
+    // message thread: the last grain ends one grain length after the delayed input stops
+    template <typename ParameterSource>
+    double getTailSeconds(ParameterSource& params) const
+    {
+        if ((bool)params.getRawParameterValue(PARAMS::GrainBypass)->load())
+            return 0.0;
+        
+        double size = params.getRawParameterValue(PARAMS::GrainSize)->load() / 1000.0;
+        double pitch = params.getRawParameterValue(PARAMS::GrainPitch)->load();
+        
+        // a grain pitched down covers its size in source time more slowly
+        return getLatencySamples() / (double)sampleRate + size * std::pow(2.0, -jmin(0.0, pitch) / 12.0);
+    }
+    
+    template <typename ParameterSource>
+    bool update(ParameterSource& params)
     {
-        bool bypass = (bool)params.getRawParameterValue(PARAMS::GrainBypass)->load();
+        if (reseedPending.exchange(false))
+            randomSpawn.setSeed(randomSeed.load());
+        
+
+        readOffset = latencySamples.load();
+        fadingOut = bypassRequested.load();
+        
+        if (bypass && !fadingOut)
+        {
+            // back from bypass the dry delay is empty, pass the input through until it has filled
+            reset();
+            bypass = false;
+            holdRemaining = readOffset;
+        }
+
         float mix = params.getRawParameterValue(PARAMS::GrainMix)->load() * 0.01f;
         float size = params.getRawParameterValue(PARAMS::GrainSize)->load();
         float density = params.getRawParameterValue(PARAMS::GrainDensity)->load();
@@ -124,13 +213,14 @@ public:
             mixer.setTargetValue(mix);
         
         for (auto& power : powerBlend)
-            power.setTargetValue(bypass ? 0.f : 1.f);
+            power.setTargetValue(fadingOut || holdRemaining > 0 ? 0.f : 1.f);
         
         setScheduler(size, density, spray);
         
         grainPitch = pitch;
         
         envelopeType = (int)params.getRawParameterValue(PARAMS::GrainEnvelope)->load();
+        onsetMode = (int)params.getRawParameterValue(PARAMS::GrainOnsetMode)->load();
         stereoRange = (int)params.getRawParameterValue(PARAMS::GrainStereo)->load();
         
         grainFreeze = (bool)params.getRawParameterValue(PARAMS::GrainFreeze)->load();
@@ -149,17 +239,77 @@ public:
         sprayFactor = spray;
     }
     
-    void spawnGrain(int index)
+    void setReadOffset(float offset)
+    {
+        // offset parameter is in miliseconds, convert from ms to samples
+        // history is written a whole block at a time, so never read closer than one block behind
+        latencySamples.store(jlimit(minReadOffset, jmax(minReadOffset, dryBuffer.getNumSamples() - 1), (int)((offset * sampleRate) / 1000.f)));
+    }
+    
+    // distance behind the write head a new grain starts reading from
+    int getGrainOffset(float playbackSpeed) const
+    {
+        if (playbackSpeed <= 1.f)
+            return readOffset;
+        
+        // an upward-pitched grain gains (speed - 1) samples on the write head every sample,
+        // start it far enough back that it reaches the write head no earlier than its last sample
+        int catchUp = (int)std::ceil(paramGrainSize * (playbackSpeed - 1.f)) + 1;
+        return jmax(readOffset, catchUp);
+    }
+    
+    // ages are measured in samples back from the end of the current block, as OnsetDetector reports them
+    int placeOnOnsets(int offset, float playbackSpeed, int samplesToBlockEnd, const CircularBuffer& history)
+    {
+        if (onsetMode == OnsetOff)
+            return offset;
+        
+        const auto& onsets = history.getOnsets();
+        const int maxAge = history.getSize() / 2;
+        int age = samplesToBlockEnd + offset;
+        
+        if (onsetMode == OnsetSnap)
+        {
+            // only look further back, moving forward would break the minimum read offset
+            int snapWindow = (int)((onsetSnapMs * sampleRate) / 1000.f);
+            int onset = onsets.findNewestOnset(age, jmin(age + snapWindow, maxAge));
+            
+            return onset >= 0 ? onset - samplesToBlockEnd : offset;
+        }
+        
+        // OnsetAvoid: push the grain back until it finishes before any transient in its path
+        int span = (int)std::ceil(paramGrainSize * playbackSpeed);
+        
+        for (int step = 0; step < maxAvoidSteps; step++)
+        {
+            int onset = onsets.findOldestOnset(age - span, age);
+            if (onset < 0)
+                return age - samplesToBlockEnd;
+            
+            age = onset + span + 1;
+            if (age > maxAge)
+                break;
+        }
+        
+        return offset;
+    }
+    
+    // upstreamLatency is how far the modules ahead of this one have delayed the buffer
+    void spawnGrain(int index, int samplesToBlockEnd, int upstreamLatency, const CircularBuffer& history)
     {
+        const int historySize = history.getSize();
         samplesSinceSpawn++;
         
         if (samplesSinceSpawn >= nextSpawn && grainPool.size() <= 20) {
             Grain newGrain;
-            newGrain.currentPos = (index - 4401.0);
             newGrain.grainSize = paramGrainSize;
             newGrain.envPos = 0;
             newGrain.playbackSpeed = std::pow(2.f, grainPitch / 12.f);
             
+            int offset = getGrainOffset(newGrain.playbackSpeed) + upstreamLatency;
+            offset = placeOnOnsets(offset, newGrain.playbackSpeed, samplesToBlockEnd, history);
+            newGrain.currentPos = index - offset;
+            
             int randomPos = randomSpawn.nextInt(Range<int>(-1 * stereoRange, stereoRange+1));
             float stereo = (float)randomPos / 100.f;
             
@@ -177,7 +327,7 @@ public:
             }
             
             if (newGrain.currentPos < 0) {
-                newGrain.currentPos += circularBuffer.getSize();
+                newGrain.currentPos += historySize;
             }
             
             grainPool.push_back(newGrain);
@@ -200,7 +350,9 @@ public:
     
     void reset()
     {
-        circularBuffer.clearBuffer();
+        dryBuffer.clear();
+        grainPool.clear();
+        samplesSinceSpawn = 0;
     }
     
     float calculateEnvelope(int tableIndex)
@@ -223,23 +375,40 @@ public:
         return envVal;
     }
     
-    void process(juce::AudioBuffer<float>& buffer)
+    float delayDry(int channel, float input)
+    {
+        int size = dryBuffer.getNumSamples();
+        dryBuffer.setSample(channel, dryWritePos, input);
+        return dryBuffer.getSample(channel, (dryWritePos - readOffset + size) % size);
+    }
+    
+    // history is the effect chain's shared input buffer, already filled with this block. The
+    // buffer has been delayed by upstreamLatency on its way here, grains read that much further back
+    void process(juce::AudioBuffer<float>& buffer, CircularBuffer& history, int upstreamLatency)
     {
         auto numSamples = buffer.getNumSamples();
         numChannels = buffer.getNumChannels();
         
-        circularBuffer.fillBuffer(buffer);
-        writePosition = circularBuffer.writePos;
+        const int historySize = history.getSize();
+        
+        // history.writePos is already past this block, step back to where the block was written
+        writePosition = (history.writePos - numSamples + historySize) % historySize;
         
         auto* channelDataL = buffer.getWritePointer(0);
         auto* channelDataR = buffer.getWritePointer(1);
         
         for (int i = 0; i < numSamples; i++)
         {
-            auto inputL = channelDataL[i];
-            auto inputR = channelDataR[i];
+            int index = (writePosition + i) % historySize;
+            
+            // dry signal is delayed by readOffset samples to match the reported latency
+            const float sourceL = channelDataL[i];
+            const float sourceR = channelDataR[i];
+            auto inputL = delayDry(0, channelDataL[i]);
+            auto inputR = delayDry(1, channelDataR[i]);
+            dryWritePos = (dryWritePos + 1) % dryBuffer.getNumSamples();
             
-            spawnGrain((writePosition + i) % circularBuffer.getSize());
+            spawnGrain(index, numSamples - i, upstreamLatency, history);
             
             float outputL = 0.f;
             float outputR = 0.f;
@@ -255,11 +424,11 @@ public:
                 double preciseIndex = grain.currentPos + (grain.envPos * grain.playbackSpeed);
                     
                 // Wrap the index around the circular buffer
-                double wrappedIndex = std::fmod(preciseIndex, (double)circularBuffer.getSize());
+                double wrappedIndex = std::fmod(preciseIndex, (double)historySize);
 
                 // Get the two integer neighbors (i and i+1)
                 int indexA = static_cast<int>(wrappedIndex);
-                int indexB = (indexA + 1) % circularBuffer.getSize();
+                int indexB = (indexA + 1) % historySize;
                     
                 // Calculate the fraction (how far we are between A and B)
                 float fraction = static_cast<float>(wrappedIndex - indexA);
@@ -270,13 +439,13 @@ public:
                 float envelope = 0.5f * calculateEnvelope(tableIndex);
 
                 // Fetch samples and interpolate: Output = A + (fraction * (B - A))
-                float sampleLA = circularBuffer.read(0, indexA);
-                float sampleLB = circularBuffer.read(0, indexB);
+                float sampleLA = history.read(0, indexA);
+                float sampleLB = history.read(0, indexB);
                 float intrpL = sampleLA + fraction * (sampleLB - sampleLA);
                 outputL += intrpL * envelope * grain.spreadL;
 
-                float sampleRA = circularBuffer.read(1, indexA);
-                float sampleRB = circularBuffer.read(1, indexB);
+                float sampleRA = history.read(1, indexA);
+                float sampleRB = history.read(1, indexB);
                 float intrpR = sampleRA + fraction * (sampleRB - sampleRA);
                 outputR += intrpR * envelope * grain.spreadR;
                 
@@ -309,40 +478,54 @@ public:
             float wet = mixerBlend[0].getTargetValue();
             float dry = 1.f - wet;
             
+            // crossfade to the undelayed input on the way in and out of bypass
+            float power = powerBlend[0].getNextValue();
             
-            if (powerBlend[0].getCurrentValue() > 0.0001 || powerBlend[0].getTargetValue() > 0.5)
-            {
-                channelDataL[i] = (dry * inputL) + (wet * (outputL));
-                channelDataR[i] = (dry * inputR) + (wet * (outputR));
-            }
-            else
-            {
-                channelDataL[i] = inputL;
-                channelDataR[i] = inputR;
-            }
+            channelDataL[i] = power * ((dry * inputL) + (wet * outputL)) + (1.f - power) * sourceL;
+            channelDataR[i] = power * ((dry * inputR) + (wet * outputR)) + (1.f - power) * sourceR;
         }
         
         cleanGrainPool();
+        
+        holdRemaining = jmax(0, holdRemaining - numSamples);
+        
+        // fully faded out, from the next block the chain passes the buffer straight through
+        if (fadingOut && powerBlend[0].getCurrentValue() <= 0.f)
+            bypass = true;
     }
     
 private:
     static constexpr auto bufferMaxSamples = 480000; // 5s @ 96k sample rate
+    static constexpr float maxReadOffsetMs = 100.f;
+    static constexpr double bypassFadeSeconds = 0.01;
+    static constexpr float onsetSnapMs = 150.f;
+    static constexpr int maxAvoidSteps = 4;
     static constexpr float pi = juce::MathConstants<float>::pi;
     
-    CircularBuffer circularBuffer;
     std::array<juce::LinearSmoothedValue<float>, 2> powerBlend, mixerBlend;
     
+    AudioBuffer<float> dryBuffer;
     std::vector<Grain> grainPool;
     juce::dsp::LookupTable<float> parabolicEnvelope, trapezoidEnvelope, bellEnvelope;
     dsp::Gain<float> outputGain;
     juce::Random randomSpawn;
+    std::atomic<int64> randomSeed { Random::getSystemRandom().nextInt64() };
+    std::atomic<bool> reseedPending { false };
+    std::atomic<int> latencySamples { 1 };
+    std::atomic<bool> bypassRequested { false };
     
-    float sampleRate, paramGrainSize, grainDensity, samplesPerGrain, grainPitch, sprayFactor, nextSpawn;
+    float sampleRate = 44100.f, paramGrainSize, grainDensity, samplesPerGrain, grainPitch, sprayFactor, nextSpawn;
     int numChannels, envelopeType, stereoRange;
+    int onsetMode = OnsetOff;
     int counter = 0;
     int samplesSinceSpawn = 0;
     int writePosition = { 0 };
+    int minReadOffset = 1;
+    int readOffset = 1;
+    int dryWritePos = 0;
+    int holdRemaining = 0;
     bool grainFreeze = false;
+    bool bypass = false, fadingOut = false;
 };
 
 
@@ -0,0 +1,151 @@
+/*
+  ==============================================================================
+
+    OnsetDetector.h
+    Created: 18 Oct 2026 3:14:22pm
+    Author:  Aidan Stephenson
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <array>
+#include <vector>
+#include <JuceHeader.h>
+using namespace juce;
+
+/*
+    Dual envelope follower running on small frames of the incoming block. Each frame is
+    rectified and peak-picked with FloatVectorOperations, then a fast and a slow follower
+    track the frame peaks; a transient is flagged when the fast follower jumps well above
+    the slow one. Work per block is one vector pass plus a few operations per frame, and
+    nothing allocates after prepare.
+
+    Onsets are kept as absolute sample times in a small ring, and queried as ages: how many
+    samples before the end of the last processed block they happened.
+*/
+class OnsetDetector
+{
+public:
+    static constexpr int frameSize = 32;
+    static constexpr int maxOnsets = 64;
+
+    void prepare(dsp::ProcessSpec& spec)
+    {
+        scratch.assign((size_t)spec.maximumBlockSize, 0.f);
+
+        double frameRate = spec.sampleRate / frameSize;
+        fastRelease = (float)std::exp(-1.0 / (fastReleaseSeconds * frameRate));
+        slowCoeff = (float)(1.0 - std::exp(-1.0 / (slowSeconds * frameRate)));
+        holdoffFrames = (int)(holdoffSeconds * frameRate);
+
+        reset();
+    }
+
+    void reset()
+    {
+        fastEnvelope = 0.f;
+        slowEnvelope = 0.f;
+        framesSinceOnset = holdoffFrames;
+        totalSamples = 0;
+        numOnsets = 0;
+        head = 0;
+    }
+
+    // extra is summed in with buffer when both are written to the history
+    void process(const AudioBuffer<float>& buffer, const AudioBuffer<float>* extra = nullptr)
+    {
+        int numSamples = jmin(buffer.getNumSamples(), (int)scratch.size());
+        float* mono = scratch.data();
+
+        // rectified mono sum of the block
+        FloatVectorOperations::clear(mono, numSamples);
+        addChannels(mono, buffer, numSamples);
+        if (extra != nullptr)
+            addChannels(mono, *extra, numSamples);
+        FloatVectorOperations::abs(mono, mono, numSamples);
+
+        for (int start = 0; start < numSamples; start += frameSize)
+        {
+            int length = jmin(frameSize, numSamples - start);
+            float peak = FloatVectorOperations::findMaximum(mono + start, length);
+
+            fastEnvelope = jmax(peak, fastEnvelope * fastRelease);
+            slowEnvelope += slowCoeff * (peak - slowEnvelope);
+
+            framesSinceOnset++;
+
+            if (framesSinceOnset >= holdoffFrames
+                && fastEnvelope > threshold
+                && fastEnvelope > slowEnvelope * onsetRatio)
+            {
+                addOnset(totalSamples + start);
+                framesSinceOnset = 0;
+            }
+        }
+
+        totalSamples += buffer.getNumSamples();
+    }
+
+    // age of the newest onset that is at least minAge and at most maxAge samples old, or -1
+    int findNewestOnset(int minAge, int maxAge) const
+    {
+        int best = -1;
+
+        for (int i = 0; i < numOnsets; i++)
+        {
+            int64 age = totalSamples - onsets[(size_t)i];
+
+            if (age >= minAge && age <= maxAge && (best < 0 || age < best))
+                best = (int)age;
+        }
+
+        return best;
+    }
+
+    // age of the oldest onset that is at least minAge and at most maxAge samples old, or -1
+    int findOldestOnset(int minAge, int maxAge) const
+    {
+        int best = -1;
+
+        for (int i = 0; i < numOnsets; i++)
+        {
+            int64 age = totalSamples - onsets[(size_t)i];
+
+            if (age >= minAge && age <= maxAge && age > best)
+                best = (int)age;
+        }
+
+        return best;
+    }
+
+private:
+    static void addChannels(float* mono, const AudioBuffer<float>& buffer, int numSamples)
+    {
+        for (int channel = 0; channel < jmin(2, buffer.getNumChannels()); channel++)
+            FloatVectorOperations::add(mono, buffer.getReadPointer(channel), jmin(numSamples, buffer.getNumSamples()));
+    }
+
+    void addOnset(int64 time)
+    {
+        onsets[(size_t)head] = time;
+        head = (head + 1) % maxOnsets;
+        numOnsets = jmin(numOnsets + 1, maxOnsets);
+    }
+
+    static constexpr double fastReleaseSeconds = 0.005;
+    static constexpr double slowSeconds = 0.1;
+    static constexpr double holdoffSeconds = 0.05;
+    static constexpr float onsetRatio = 2.f;    // fast envelope 6dB above slow
+    static constexpr float threshold = 0.003f;  // about -50dBFS
+
+    std::vector<float> scratch;
+    std::array<int64, maxOnsets> onsets {};
+
+    float fastEnvelope = 0.f, slowEnvelope = 0.f;
+    float fastRelease = 0.f, slowCoeff = 0.f;
+    int holdoffFrames = 0, framesSinceOnset = 0;
+    int numOnsets = 0, head = 0;
+    int64 totalSamples = 0;
+};
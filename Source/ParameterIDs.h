@@ -0,0 +1,53 @@
+/*
+  ==============================================================================
+
+    ParameterIDs.h
+    Created: 18 Oct 2026 10:12:30am
+    Author:  Aidan Stephenson
+
+  ==============================================================================
+*/
+
+#pragma once
+
+namespace PARAMS
+{
+    #define PARAMETER_ID(str) constexpr const char* str { #str };
+
+    // Effect chain
+    PARAMETER_ID(ChainOrder)
+    PARAMETER_ID(PresetMorph)
+    PARAMETER_ID(HistorySource)
+    PARAMETER_ID(SidechainDuck)
+
+    // Delay
+    PARAMETER_ID(DelayMix)
+    PARAMETER_ID(DelayBypass)
+    PARAMETER_ID(DelayTime)
+    PARAMETER_ID(DelayFeedback)
+
+    // Granular
+    PARAMETER_ID(GrainMix)
+    PARAMETER_ID(GrainBypass)
+    PARAMETER_ID(GrainSize)
+    PARAMETER_ID(GrainDensity)
+    PARAMETER_ID(GrainPitch)
+    PARAMETER_ID(GrainEnvelope)
+    PARAMETER_ID(GrainFreeze)
+    PARAMETER_ID(GrainDelay)
+    PARAMETER_ID(GrainFeedback)
+    PARAMETER_ID(GrainStereo)
+    PARAMETER_ID(GrainOnset)
+    PARAMETER_ID(GrainOnsetMode)
+
+    // Pitch shift / shimmer
+    PARAMETER_ID(PitchMix)
+    PARAMETER_ID(PitchBypass)
+    PARAMETER_ID(PitchShift)
+    PARAMETER_ID(PitchFormant)
+    PARAMETER_ID(PitchKeepFormants)
+    PARAMETER_ID(PitchQuality)
+    PARAMETER_ID(PitchShimmer)
+    PARAMETER_ID(PitchShimmerFeedback)
+    PARAMETER_ID(PitchShimmerSize)
+}
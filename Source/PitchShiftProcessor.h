@@ -0,0 +1,623 @@
+/*
+  ==============================================================================
+
+    PitchShiftProcessor.h
+    Created: 18 Oct 2026 5:02:41pm
+    Author:  Aidan Stephenson
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <vector>
+#include <JuceHeader.h>
+#include "CircularBuffer.h"
+#include "ParameterIDs.h"
+using namespace juce;
+
+inline StringArray pitchQualities =
+{
+    "1024",
+    "2048",
+    "4096",
+};
+
+/*
+    Phase vocoder pitch and formant shifter, overlap-add with 4x overlap and Hann windows.
+    Magnitudes are whitened by a smoothed spectral envelope before the bins are shifted,
+    then the envelope is put back warped by the formant ratio. Formants follow the pitch
+    unless Keep Formants is on, and Formant shifts them further either way.
+
+    The work for each frame is split into stages (forward FFT, bin processing, inverse FFT
+    and overlap-add, per channel) which are spread evenly across the hop, so a large FFT
+    never lands on a single callback. Finishing a frame within the next hop costs one hop
+    of extra latency on top of the frame length.
+
+    In shimmer mode the shifted signal runs through a reverb whose output is added to the
+    wet signal and fed back into the shifter input through a fixed delay line, so the loop
+    time doesn't depend on the host's block size. The reverb runs at unity wet gain and the
+    feedback is soft limited, which keeps the loop bounded at any feedback setting.
+
+    Bypass crossfades to the undelayed input before the chain stops calling us, and coming
+    back the input passes straight through until the restarted delay lines have filled.
+    The input and dry delay lines keep running through frame size changes. A new
+    frame size waits for the wet signal to fade out, the dry signal crossfades from the old
+    latency to the new one, and the wet fades back in once the new frames are running.
+*/
+class PitchShiftProcessor
+{
+public:
+    PitchShiftProcessor() {}
+
+    void prepare(dsp::ProcessSpec& spec)
+    {
+        sampleRate = spec.sampleRate;
+        numChannels = jmin((int)spec.numChannels, maxChannels);
+
+        for (int index = 0; index < numQualities; index++)
+        {
+            int size = 1 << (minOrder + index);
+            ffts[(size_t)index] = std::make_unique<dsp::FFT>(minOrder + index);
+
+            // periodic Hann window, used for both analysis and synthesis
+            auto& window = windows[(size_t)index];
+            window.resize((size_t)size);
+            for (int j = 0; j < size; j++)
+                window[(size_t)j] = 0.5f - 0.5f * std::cos(2.f * pi * (float)j / (float)size);
+        }
+
+        for (auto& channel : channelStates)
+            channel.allocate();
+
+        shimmerBuffer.setSize(2, (int)spec.maximumBlockSize);
+        wetBuffer.setSize(2, (int)spec.maximumBlockSize);
+        inputBuffer.setSize(2, (int)spec.maximumBlockSize);
+
+        // at least a block long, so each block only reads what earlier blocks wrote
+        shimmerDelay.setSize(2, jmax((int)spec.maximumBlockSize, (int)(shimmerDelayMs * sampleRate / 1000.0)));
+        dryFadeSamples = jmax(1, (int)(fadeSeconds * sampleRate));
+        wetGate.reset(sampleRate, fadeSeconds);
+        bypassFade.reset(sampleRate, fadeSeconds);
+
+        dsp::ProcessSpec reverbSpec { spec.sampleRate, spec.maximumBlockSize, 2 };
+        reverb.prepare(reverbSpec);
+
+        for (auto& mixer : mixerBlend)
+            mixer.reset(sampleRate, 0.02);
+
+        quality = requestedQuality = pendingQuality.load();
+        bypass = fadingOut = bypassRequested.load();
+        holdRemaining = 0;
+        bypassFade.setCurrentAndTargetValue(bypass ? 0.f : 1.f);
+        setQuality(quality);
+        reset();
+    }
+
+    void addParams(AudioProcessorParameterGroup& params)
+    {
+        params.addChild(std::make_unique<AudioParameterBool>(ParameterID(PARAMS::PitchBypass, 1), "Pitch Bypass", true,
+                                                             AudioParameterBoolAttributes().withAutomatable(false)));
+        params.addChild(std::make_unique<AudioParameterFloat>(ParameterID(PARAMS::PitchMix, 1), "Pitch Mix", NormalisableRange<float>(0.f, 100.f, 1.f), 50.f));
+        params.addChild(std::make_unique<AudioParameterFloat>(ParameterID(PARAMS::PitchShift, 1), "Pitch Shift", NormalisableRange<float>(-12.f, 12.f, 0.01f), 12.f));
+        params.addChild(std::make_unique<AudioParameterFloat>(ParameterID(PARAMS::PitchFormant, 1), "Formant", NormalisableRange<float>(-12.f, 12.f, 0.01f), 0.f));
+        params.addChild(std::make_unique<AudioParameterBool>(ParameterID(PARAMS::PitchKeepFormants, 1), "Keep Formants", false));
+        params.addChild(std::make_unique<AudioParameterChoice>(ParameterID(PARAMS::PitchQuality, 1), "FFT Size", pitchQualities, 1,
+                                                                   AudioParameterChoiceAttributes().withAutomatable(false)));
+
+        params.addChild(std::make_unique<AudioParameterBool>(ParameterID(PARAMS::PitchShimmer, 1), "Shimmer", false));
+        params.addChild(std::make_unique<AudioParameterFloat>(ParameterID(PARAMS::PitchShimmerFeedback, 1), "Shimmer Feedback", NormalisableRange<float>(0.f, 90.f, 1.f), 50.f));
+        params.addChild(std::make_unique<AudioParameterFloat>(ParameterID(PARAMS::PitchShimmerSize, 1), "Shimmer Size", NormalisableRange<float>(0.f, 100.f, 1.f), 70.f));
+    }
+
+    static String getName()
+    {
+        return "Pitch";
+    }
+
+    // audio thread: the chain skips us while this is true
+    bool isBypassed() const
+    {
+        return bypass;
+    }
+
+    // frame length plus the hop it takes to finish the staged work; the dry signal is delayed to
+    // match. Bypassed there is no delay at all
+    int getLatencySamples() const
+    {
+        if (bypassRequested.load())
+            return 0;
+
+        int size = 1 << (minOrder + pendingQuality.load());
+        return size + size / overlap;
+    }
+
+    // message thread: FFT Size and Bypass set the latency, so they are not automatable and the
+    // audio thread only picks them up from here
+    template <typename ParameterSource>
+    void applyLatencySettings(ParameterSource& params)
+    {
+        pendingQuality.store(jlimit(0, numQualities - 1, (int)params.getRawParameterValue(PARAMS::PitchQuality)->load()));
+        bypassRequested.store((bool)params.getRawParameterValue(PARAMS::PitchBypass)->load());
+    }
+
+    // message thread: the shifted frames plus, in shimmer mode, the reverb tail and every pass
+    // around the feedback loop until it has dropped 60dB
+    template <typename ParameterSource>
+    double getTailSeconds(ParameterSource& params) const
+    {
+        if ((bool)params.getRawParameterValue(PARAMS::PitchBypass)->load())
+            return 0.0;
+
+        double latency = getLatencySamples() / sampleRate;
+
+        if (!(bool)params.getRawParameterValue(PARAMS::PitchShimmer)->load())
+            return latency;
+
+        // dsp::Reverb's comb filters feed back roomSize * 0.28 + 0.7 every ~35ms
+        double combFeedback = params.getRawParameterValue(PARAMS::PitchShimmerSize)->load() * 0.01 * 0.28 + 0.7;
+        double reverbSeconds = 3.0 * 0.035 / -std::log10(combFeedback);
+
+        double gain = params.getRawParameterValue(PARAMS::PitchShimmerFeedback)->load() * 0.01;
+        double passes = gain > 0.0 ? std::ceil(std::log(0.001) / std::log(gain)) : 0.0;
+
+        return latency + reverbSeconds + passes * (shimmerDelayMs / 1000.0 + latency);
+    }
+
+    template <typename ParameterSource>
+    bool update(ParameterSource& params)
+    {
+        float mix = params.getRawParameterValue(PARAMS::PitchMix)->load() * 0.01f;
+        float pitch = params.getRawParameterValue(PARAMS::PitchShift)->load();
+        float formant = params.getRawParameterValue(PARAMS::PitchFormant)->load();
+
+        for (auto& mixer : mixerBlend)
+            mixer.setTargetValue(mix);
+
+        pitchRatio = std::pow(2.f, pitch / 12.f);
+        formantRatio = std::pow(2.f, formant / 12.f);
+
+        if (!(bool)params.getRawParameterValue(PARAMS::PitchKeepFormants)->load())
+            formantRatio *= pitchRatio;
+
+        bool wasShimmer = shimmer;
+        shimmer = (bool)params.getRawParameterValue(PARAMS::PitchShimmer)->load();
+        shimmerFeedback = params.getRawParameterValue(PARAMS::PitchShimmerFeedback)->load() * 0.01f;
+
+        dsp::Reverb::Parameters reverbParams;
+        reverbParams.roomSize = params.getRawParameterValue(PARAMS::PitchShimmerSize)->load() * 0.01f;
+        reverbParams.damping = 0.3f;
+        reverbParams.wetLevel = 1.f / 3.f;     // Reverb scales wet by 3, this is unity
+        reverbParams.dryLevel = 0.f;
+        reverbParams.width = 1.f;
+        reverb.setParameters(reverbParams);
+
+        // an old tail left in the loop would come back in at full level
+        if (shimmer && !wasShimmer)
+            clearShimmer();
+
+        requestedQuality = pendingQuality.load();
+
+        fadingOut = bypassRequested.load();
+
+        if (bypass && !fadingOut)
+        {
+            // nothing ran in bypass, start from empty delay lines at the current frame size and
+            // pass the input through until they hold a full latency
+            if (requestedQuality != quality)
+                setQuality(requestedQuality);
+
+            reset();
+            bypass = false;
+            holdRemaining = fftSize + hopSize;
+
+            // frames spanning the restart see a step from silence, the wet comes in after them
+            wetGate.setCurrentAndTargetValue(0.f);
+            wetHoldRemaining = 2 * holdRemaining;
+        }
+        else if (requestedQuality != quality)
+        {
+            wetGate.setTargetValue(0.f);
+        }
+
+        bypassFade.setTargetValue(fadingOut || holdRemaining > 0 ? 0.f : 1.f);
+
+        return true;
+    }
+
+    void reset()
+    {
+        for (auto& channel : channelStates)
+            channel.clear();
+
+        clearShimmer();
+        samplesProcessed = 0;
+        hopCounter = 0;
+        nextStage = numStages;
+        dryFadeRemaining = 0;
+        wetHoldRemaining = 0;
+        wetGate.setCurrentAndTargetValue(1.f);
+    }
+
+    // the shifter works on the block it is given, the shared history is not used
+    void process(juce::AudioBuffer<float>& buffer, CircularBuffer&, int)
+    {
+        const int numSamples = jmin(buffer.getNumSamples(), wetBuffer.getNumSamples());
+        const int channels = jmin(buffer.getNumChannels(), numChannels);
+
+        if (channels <= 0)
+            return;
+
+        // the undelayed input, for the bypass crossfade
+        for (int c = 0; c < channels; c++)
+            inputBuffer.copyFrom(c, 0, buffer, c, 0, numSamples);
+
+        // a new frame size waits until the wet signal has faded out
+        if (requestedQuality != quality && wetGate.getCurrentValue() <= 0.f)
+            setQuality(requestedQuality);
+
+        // restarted frames only give full output one latency later, the wet stays out until then
+        if (wetHoldRemaining > 0)
+        {
+            wetHoldRemaining -= numSamples;
+            if (wetHoldRemaining <= 0 && requestedQuality == quality)
+                wetGate.setTargetValue(1.f);
+        }
+
+        numStages = stagesPerChannel * channels;
+        stageInterval = hopSize / numStages;
+
+        for (int i = 0; i < numSamples; i++)
+        {
+            const int inPos = (int)(samplesProcessed % ringSize);
+            const int shimmerPos = (shimmerWritePos + i) % shimmerDelay.getNumSamples();
+
+            for (int c = 0; c < channels; c++)
+            {
+                auto& state = channelStates[(size_t)c];
+                float input = buffer.getSample(c, i);
+
+                // the reverb tail from one shimmer delay ago, soft limited so the loop stays bounded
+                float feedback = shimmer ? shimmerFeedback * std::tanh(shimmerDelay.getSample(c, shimmerPos)) : 0.f;
+
+                state.input[(size_t)inPos] = input + feedback;
+                state.dry[(size_t)inPos] = input;
+            }
+
+            samplesProcessed++;
+
+            if (++hopCounter >= hopSize)
+            {
+                // any stage still pending belongs to the previous frame, finish it before moving on
+                while (nextStage < numStages)
+                    runStage(nextStage++, channels);
+
+                hopCounter = 0;
+                frameStart = samplesProcessed;
+                nextStage = 0;
+            }
+
+            while (nextStage < numStages && hopCounter >= nextStage * stageInterval)
+                runStage(nextStage++, channels);
+
+            const int64 now = samplesProcessed - 1;
+            const int outPos = (int)(now % outputSize);
+
+            for (int c = 0; c < channels; c++)
+            {
+                auto& state = channelStates[(size_t)c];
+                wetBuffer.setSample(c, i, state.output[(size_t)outPos]);
+                state.output[(size_t)outPos] = 0.f;
+
+                buffer.setSample(c, i, readDry(state, now));
+            }
+
+            if (dryFadeRemaining > 0)
+                dryFadeRemaining--;
+        }
+
+        if (shimmer)
+        {
+            // reverb the shifted signal, add the tail to the wet output and delay it for feedback
+            for (int c = 0; c < 2; c++)
+                shimmerBuffer.copyFrom(c, 0, wetBuffer, jmin(c, channels - 1), 0, numSamples);
+
+            dsp::AudioBlock<float> block(shimmerBuffer.getArrayOfWritePointers(), 2, (size_t)numSamples);
+            reverb.process(dsp::ProcessContextReplacing<float>(block));
+
+            for (int c = 0; c < channels; c++)
+                wetBuffer.addFrom(c, 0, shimmerBuffer, c, 0, numSamples);
+
+            // every sample written here was read above, so the loop delay is the delay line length
+            const int delaySize = shimmerDelay.getNumSamples();
+            for (int c = 0; c < 2; c++)
+                for (int i = 0; i < numSamples; i++)
+                    shimmerDelay.setSample(c, (shimmerWritePos + i) % delaySize, shimmerBuffer.getSample(c, i));
+
+            shimmerWritePos = (shimmerWritePos + numSamples) % delaySize;
+        }
+
+        for (int i = 0; i < numSamples; i++)
+        {
+            // the gate pulls the mix back to dry, so a frame size change never leaves a gap
+            float wet = mixerBlend[0].getNextValue() * wetGate.getNextValue();
+            float dry = 1.f - wet;
+            float power = bypassFade.getNextValue();
+
+            for (int c = 0; c < channels; c++)
+            {
+                float mixed = (dry * buffer.getSample(c, i)) + (wet * wetBuffer.getSample(c, i));
+                buffer.setSample(c, i, power * mixed + (1.f - power) * inputBuffer.getSample(c, i));
+            }
+        }
+
+        holdRemaining = jmax(0, holdRemaining - numSamples);
+
+        // fully faded out, from the next block the chain passes the buffer straight through
+        if (fadingOut && bypassFade.getCurrentValue() <= 0.f)
+            bypass = true;
+    }
+
+private:
+    struct ChannelState
+    {
+        void allocate()
+        {
+            int numBins = maxSize / 2 + 1;
+
+            frame.resize((size_t)(2 * maxSize));
+            input.resize((size_t)ringSize);
+            dry.resize((size_t)ringSize);
+            output.resize((size_t)outputSize);
+
+            for (auto* bins : { &lastPhase, &sumPhase, &magnitude, &frequency, &envelope, &synthMagnitude, &synthFrequency })
+                bins->resize((size_t)numBins);
+
+            clear();
+        }
+
+        void clear()
+        {
+            std::fill(input.begin(), input.end(), 0.f);
+            std::fill(dry.begin(), dry.end(), 0.f);
+            clearFrames();
+        }
+
+        // everything but the input and dry delay lines
+        void clearFrames()
+        {
+            for (auto* data : { &frame, &output, &lastPhase, &sumPhase, &magnitude, &frequency, &envelope, &synthMagnitude, &synthFrequency })
+                std::fill(data->begin(), data->end(), 0.f);
+        }
+
+        std::vector<float> frame, input, dry, output;
+        std::vector<float> lastPhase, sumPhase, magnitude, frequency, envelope, synthMagnitude, synthFrequency;
+    };
+
+    enum Stage
+    {
+        Analysis = 0,
+        Spectral = 1,
+        Synthesis = 2,
+    };
+
+    // the ring is cleared on reset and longer than any latency, so reads from before the
+    // first sample find silence
+    float readDry(const ChannelState& state, int64 now) const
+    {
+        float delayed = state.dry[(size_t)((now - (fftSize + hopSize) + ringSize) % ringSize)];
+
+        if (dryFadeRemaining <= 0)
+            return delayed;
+
+        float previous = state.dry[(size_t)((now - previousLatency + ringSize) % ringSize)];
+        float t = (float)dryFadeRemaining / (float)dryFadeSamples;
+        return delayed + t * (previous - delayed);
+    }
+
+    void clearFrames()
+    {
+        for (auto& channel : channelStates)
+            channel.clearFrames();
+
+        hopCounter = 0;
+        nextStage = numStages;
+        wetHoldRemaining = fftSize + hopSize;
+    }
+
+    void clearShimmer()
+    {
+        shimmerDelay.clear();
+        shimmerWritePos = 0;
+        reverb.reset();
+    }
+
+    // the input and dry lines keep running, only the frames start over
+    void setQuality(int newQuality)
+    {
+        previousLatency = fftSize + hopSize;
+        dryFadeRemaining = dryFadeSamples;
+
+        quality = newQuality;
+        fftSize = 1 << (minOrder + quality);
+        hopSize = fftSize / overlap;
+        numBins = fftSize / 2 + 1;
+
+        float windowPower = 0.f;
+        for (auto w : windows[(size_t)quality])
+            windowPower += w * w;
+
+        overlapGain = (float)hopSize / windowPower;
+
+        clearFrames();
+    }
+
+    void runStage(int stage, int channels)
+    {
+        auto& state = channelStates[(size_t)(stage % channels)];
+
+        switch (stage / channels)
+        {
+            case Analysis:
+                analyse(state);
+                break;
+            case Spectral:
+                shiftBins(state);
+                break;
+            case Synthesis:
+                synthesise(state);
+                break;
+        }
+    }
+
+    void analyse(ChannelState& state)
+    {
+        const auto& window = windows[(size_t)quality];
+        float* frame = state.frame.data();
+
+        for (int j = 0; j < fftSize; j++)
+        {
+            int pos = (int)((frameStart - fftSize + j + ringSize) % ringSize);
+            frame[j] = state.input[(size_t)pos] * window[(size_t)j];
+        }
+
+        FloatVectorOperations::clear(frame + fftSize, fftSize);
+        ffts[(size_t)quality]->performRealOnlyForwardTransform(frame, true);
+    }
+
+    void shiftBins(ChannelState& state)
+    {
+        float* frame = state.frame.data();
+        const float expected = 2.f * pi * (float)hopSize / (float)fftSize;
+
+        // magnitude and true frequency (in bins) of every analysis bin
+        for (int k = 0; k < numBins; k++)
+        {
+            float real = frame[2 * k];
+            float imag = frame[2 * k + 1];
+            float phase = std::atan2(imag, real);
+
+            float delta = phase - state.lastPhase[(size_t)k] - (float)k * expected;
+            state.lastPhase[(size_t)k] = phase;
+            delta -= 2.f * pi * std::round(delta / (2.f * pi));
+
+            state.magnitude[(size_t)k] = std::sqrt(real * real + imag * imag);
+            state.frequency[(size_t)k] = (float)k + delta / expected;
+        }
+
+        computeEnvelope(state);
+
+        FloatVectorOperations::clear(state.synthMagnitude.data(), numBins);
+        FloatVectorOperations::clear(state.synthFrequency.data(), numBins);
+
+        // move whitened bins to their shifted position
+        for (int k = 0; k < numBins; k++)
+        {
+            int target = (int)((float)k * pitchRatio + 0.5f);
+            if (target >= numBins)
+                break;
+
+            state.synthMagnitude[(size_t)target] += state.magnitude[(size_t)k] / (state.envelope[(size_t)k] + 1.0e-9f);
+            state.synthFrequency[(size_t)target] = state.frequency[(size_t)k] * pitchRatio;
+        }
+
+        // put the envelope back, warped by the formant ratio, and accumulate synthesis phase
+        for (int k = 0; k < numBins; k++)
+        {
+            int source = (int)((float)k / formantRatio + 0.5f);
+            float envelope = source < numBins ? state.envelope[(size_t)source] : 0.f;
+            float magnitude = state.synthMagnitude[(size_t)k] * envelope;
+
+            state.sumPhase[(size_t)k] += state.synthFrequency[(size_t)k] * expected;
+            float phase = state.sumPhase[(size_t)k] - 2.f * pi * std::floor(state.sumPhase[(size_t)k] / (2.f * pi));
+            state.sumPhase[(size_t)k] = phase;
+
+            frame[2 * k] = magnitude * std::cos(phase);
+            frame[2 * k + 1] = magnitude * std::sin(phase);
+        }
+    }
+
+    // moving average of the magnitudes, wide enough to smooth over harmonics
+    void computeEnvelope(ChannelState& state)
+    {
+        const int radius = jmax(2, fftSize / 256);
+        const float* magnitude = state.magnitude.data();
+        float* envelope = state.envelope.data();
+
+        float sum = 0.f;
+        int count = 0;
+
+        for (int k = 0; k <= jmin(radius, numBins - 1); k++, count++)
+            sum += magnitude[k];
+
+        for (int k = 0; k < numBins; k++)
+        {
+            envelope[k] = sum / (float)count;
+
+            int entering = k + radius + 1;
+            int leaving = k - radius;
+
+            if (entering < numBins)
+            {
+                sum += magnitude[entering];
+                count++;
+            }
+
+            if (leaving >= 0)
+            {
+                sum -= magnitude[leaving];
+                count--;
+            }
+        }
+    }
+
+    void synthesise(ChannelState& state)
+    {
+        const auto& window = windows[(size_t)quality];
+        float* frame = state.frame.data();
+
+        ffts[(size_t)quality]->performRealOnlyInverseTransform(frame);
+
+        // this frame covers inputs frameStart - fftSize onwards, written out one latency later
+        for (int j = 0; j < fftSize; j++)
+        {
+            int pos = (int)((frameStart + hopSize + j) % outputSize);
+            state.output[(size_t)pos] += frame[j] * window[(size_t)j] * overlapGain;
+        }
+    }
+
+    static constexpr int maxChannels = 2;
+    static constexpr int minOrder = 10;
+    static constexpr int numQualities = 3;
+    static constexpr int maxSize = 1 << (minOrder + numQualities - 1);
+    static constexpr int ringSize = 2 * maxSize;     // input and dry history, holds a frame plus a hop
+    static constexpr int outputSize = 4 * maxSize;   // overlap-add accumulator
+    static constexpr int overlap = 4;
+    static constexpr int stagesPerChannel = 3;
+    static constexpr double shimmerDelayMs = 50.0;
+    static constexpr double fadeSeconds = 0.01;
+    static constexpr float pi = juce::MathConstants<float>::pi;
+
+    std::array<std::unique_ptr<dsp::FFT>, numQualities> ffts;
+    std::array<std::vector<float>, numQualities> windows;
+    std::array<ChannelState, maxChannels> channelStates;
+    std::atomic<int> pendingQuality { 1 };
+    std::atomic<bool> bypassRequested { true };
+
+    AudioBuffer<float> wetBuffer, inputBuffer, shimmerBuffer, shimmerDelay;
+    dsp::Reverb reverb;
+    std::array<juce::LinearSmoothedValue<float>, 2> mixerBlend;
+    juce::LinearSmoothedValue<float> wetGate, bypassFade;
+
+    double sampleRate = 44100.0;
+    float pitchRatio = 1.f, formantRatio = 1.f, overlapGain = 1.f, shimmerFeedback = 0.f;
+    int numChannels = 2, quality = 1, requestedQuality = 1, fftSize = 2048, hopSize = 512, numBins = 1025;
+    int numStages = stagesPerChannel * maxChannels, stageInterval = 1, nextStage = stagesPerChannel * maxChannels;
+    int hopCounter = 0, shimmerWritePos = 0;
+    int previousLatency = 0, dryFadeSamples = 1, dryFadeRemaining = 0, wetHoldRemaining = 0, holdRemaining = 0;
+    int64 samplesProcessed = 0, frameStart = 0;
+    bool bypass = true, fadingOut = true, shimmer = false;
+};
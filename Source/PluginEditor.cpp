@@ -11,15 +11,44 @@
 
 //==============================================================================
 CapstonePluginAudioProcessorEditor::CapstonePluginAudioProcessorEditor (CapstonePluginAudioProcessor& p)
-    : AudioProcessorEditor (&p), audioProcessor (p)
+    : AudioProcessorEditor (&p), audioProcessor (p), presetBank (p.getPresetBank()), parameterEditor (p)
 {
+    presetBox.setTextWhenNothingSelected ("Preset");
+    presetBox.onChange = [this]
+    {
+        int index = presetBox.getSelectedId() - 1;
+        if (index >= 0 && index != presetBank.getCurrentPreset())
+        {
+            audioProcessor.setCurrentProgram (index);
+            audioProcessor.updateHostDisplay (juce::AudioProcessorListener::ChangeDetails().withProgramChanged (true));
+        }
+    };
+    
+    storeButton.onClick = [this]
+    {
+        presetBank.capturePreset ("Preset " + juce::String (presetBank.getNumPresets() + 1));
+        audioProcessor.updateHostDisplay (juce::AudioProcessorListener::ChangeDetails().withProgramChanged (true));
+    };
+    
+    morphABox.setTextWhenNothingSelected ("Morph A");
+    morphBBox.setTextWhenNothingSelected ("Morph B");
+    morphABox.onChange = [this] { morphChanged(); };
+    morphBBox.onChange = [this] { morphChanged(); };
+    
+    for (auto* component : std::initializer_list<juce::Component*> { &presetBox, &storeButton, &morphABox, &morphBBox, &parameterEditor })
+        addAndMakeVisible (component);
+    
+    presetBank.addChangeListener (this);
+    refreshPresets();
+    
     // Make sure that before the constructor has finished, you've set the
     // editor's size to whatever you need it to be.
-    setSize (400, 300);
+    setSize (juce::jmax (480, parameterEditor.getWidth()), parameterEditor.getHeight() + presetBarHeight);
 }
 
 CapstonePluginAudioProcessorEditor::~CapstonePluginAudioProcessorEditor()
 {
+    presetBank.removeChangeListener (this);
 }
 
 //==============================================================================
@@ -27,14 +56,77 @@ void CapstonePluginAudioProcessorEditor::paint (juce::Graphics& g)
 {
     // (Our component is opaque, so we must completely fill the background with a solid colour)
     g.fillAll (getLookAndFeel().findColour (juce::ResizableWindow::backgroundColourId));
-
-    g.setColour (juce::Colours::white);
-    g.setFont (juce::FontOptions (15.0f));
-    g.drawFittedText ("Hello World!", getLocalBounds(), juce::Justification::centred, 1);
 }
 
 void CapstonePluginAudioProcessorEditor::resized()
 {
-    // This is generally where you'll want to lay out the positions of any
-    // subcomponents in your editor..
+    auto bounds = getLocalBounds();
+    auto bar = bounds.removeFromTop (presetBarHeight).reduced (4);
+    int boxWidth = (bar.getWidth() - 60) / 3;
+    
+    presetBox.setBounds (bar.removeFromLeft (boxWidth));
+    storeButton.setBounds (bar.removeFromLeft (60).reduced (4, 0));
+    morphABox.setBounds (bar.removeFromLeft (boxWidth));
+    morphBBox.setBounds (bar);
+    
+    parameterEditor.setBounds (bounds);
+}
+
+void CapstonePluginAudioProcessorEditor::changeListenerCallback (juce::ChangeBroadcaster*)
+{
+    refreshPresets();
+}
+
+void CapstonePluginAudioProcessorEditor::refreshPresets()
+{
+    int morphA = morphABox.getSelectedId();
+    int morphB = morphBBox.getSelectedId();
+    
+    presetBox.clear (juce::dontSendNotification);
+    morphABox.clear (juce::dontSendNotification);
+    morphBBox.clear (juce::dontSendNotification);
+    
+    morphABox.addItem ("No Morph", 1);
+    morphBBox.addItem ("No Morph", 1);
+    
+    for (int i = 0; i < presetBank.getNumPresets(); i++)
+    {
+        presetBox.addItem (presetBank.getPresetName (i), i + 1);
+        morphABox.addItem (presetBank.getPresetName (i), i + firstMorphPresetId);
+        morphBBox.addItem (presetBank.getPresetName (i), i + firstMorphPresetId);
+    }
+    
+    presetBox.setSelectedId (presetBank.getCurrentPreset() + 1, juce::dontSendNotification);
+    
+    if (presetBank.getMorphPresetA() >= 0)
+    {
+        morphA = presetBank.getMorphPresetA() + firstMorphPresetId;
+        morphB = presetBank.getMorphPresetB() + firstMorphPresetId;
+    }
+    else if (morphA >= firstMorphPresetId && morphB >= firstMorphPresetId)
+    {
+        // a full pair on screen but none in the bank, the morph was cleared by a recall
+        morphA = morphB = 1;
+    }
+    
+    // a half-chosen pair stays as it is until the other side is picked
+    morphABox.setSelectedId (morphA, juce::dontSendNotification);
+    morphBBox.setSelectedId (morphB, juce::dontSendNotification);
+}
+
+void CapstonePluginAudioProcessorEditor::morphChanged()
+{
+    int indexA = morphABox.getSelectedId() - firstMorphPresetId;
+    int indexB = morphBBox.getSelectedId() - firstMorphPresetId;
+    
+    if (indexA >= 0 && indexB >= 0)
+    {
+        presetBank.setMorphPresets (indexA, indexB);
+    }
+    else if (morphABox.getSelectedId() == 1 || morphBBox.getSelectedId() == 1)
+    {
+        morphABox.setSelectedId (1, juce::dontSendNotification);
+        morphBBox.setSelectedId (1, juce::dontSendNotification);
+        presetBank.clearMorph();
+    }
 }
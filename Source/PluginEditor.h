@@ -13,8 +13,11 @@
 
 //==============================================================================
 /**
+    Generic parameter editor with a preset bar on top: recall and store presets,
+    and pick the two presets Preset Morph blends between.
 */
-class CapstonePluginAudioProcessorEditor  : public juce::AudioProcessorEditor
+class CapstonePluginAudioProcessorEditor  : public juce::AudioProcessorEditor,
+                                            private juce::ChangeListener
 {
 public:
     CapstonePluginAudioProcessorEditor (CapstonePluginAudioProcessor&);
@@ -25,9 +28,22 @@ public:
     void resized() override;
 
 private:
+    void changeListenerCallback (juce::ChangeBroadcaster*) override;
+    void refreshPresets();
+    void morphChanged();
+    
     // This reference is provided as a quick way for your editor to
     // access the processor object that created it.
     CapstonePluginAudioProcessor& audioProcessor;
+    PresetBank& presetBank;
+    
+    // morph boxes list "No Morph" first, presets follow from this id
+    static constexpr int firstMorphPresetId = 2;
+    static constexpr int presetBarHeight = 32;
+    
+    juce::ComboBox presetBox, morphABox, morphBBox;
+    juce::TextButton storeButton { "Store" };
+    juce::GenericAudioProcessorEditor parameterEditor;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CapstonePluginAudioProcessorEditor)
 };
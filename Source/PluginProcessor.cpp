@@ -16,6 +16,7 @@ CapstonePluginAudioProcessor::CapstonePluginAudioProcessor()
                      #if ! JucePlugin_IsMidiEffect
                       #if ! JucePlugin_IsSynth
                        .withInput  ("Input",  juce::AudioChannelSet::stereo(), true)
+                       .withInput  ("Sidechain", juce::AudioChannelSet::stereo(), false)
                       #endif
                        .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
                      #endif
@@ -23,10 +24,21 @@ CapstonePluginAudioProcessor::CapstonePluginAudioProcessor()
 #endif
 {
     parameters = std::make_unique<juce::AudioProcessorValueTreeState>(*this, /*undoManager.get()*/ nullptr, "Params", createParameterLayout());
+    presetBank = std::make_unique<PresetBank>(*parameters);
+    
+    parameters->addParameterListener (PARAMS::GrainDelay, this);
+    parameters->addParameterListener (PARAMS::GrainBypass, this);
+    parameters->addParameterListener (PARAMS::PitchQuality, this);
+    parameters->addParameterListener (PARAMS::PitchBypass, this);
 }
 
 CapstonePluginAudioProcessor::~CapstonePluginAudioProcessor()
 {
+    parameters->removeParameterListener (PARAMS::GrainDelay, this);
+    parameters->removeParameterListener (PARAMS::GrainBypass, this);
+    parameters->removeParameterListener (PARAMS::PitchQuality, this);
+    parameters->removeParameterListener (PARAMS::PitchBypass, this);
+    cancelPendingUpdate();
 }
 
 std::unique_ptr<juce::AudioProcessorParameterGroup> CapstonePluginAudioProcessor::createParameterLayout()
@@ -34,11 +46,10 @@ std::unique_ptr<juce::AudioProcessorParameterGroup> CapstonePluginAudioProcessor
     // parameters group of all modules
     std::unique_ptr<juce::AudioProcessorParameterGroup> params = std::make_unique<juce::AudioProcessorParameterGroup>("Parameters", "", "");
 
-    // Module name
-    // juce::String name = delayProcessor.getName();
-    // get params from module processor
-    //delayProcessor.addParams(*params);
-    grainProcessor.addParams(*params);
+    // get params from every module in the chain
+    effectChain.addParams(*params);
+    
+    params->addChild(std::make_unique<AudioParameterFloat>(ParameterID(PARAMS::PresetMorph, 1), "Preset Morph", NormalisableRange<float>(0.f, 100.f, 0.1f), 0.f));
 
     return params;
 }
@@ -78,31 +89,34 @@ bool CapstonePluginAudioProcessor::isMidiEffect() const
 
 double CapstonePluginAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    // delay repeats and the shimmer loop ring on after the input stops
+    return effectChain.getTailLengthSeconds (*parameters);
 }
 
+// programs are the preset bank, which always holds at least the Init preset
 int CapstonePluginAudioProcessor::getNumPrograms()
 {
-    return 1;   // NB: some hosts don't cope very well if you tell them there are 0 programs,
-                // so this should be at least 1, even if you're not really implementing programs.
+    return juce::jmax (1, presetBank->getNumPresets());
 }
 
 int CapstonePluginAudioProcessor::getCurrentProgram()
 {
-    return 0;
+    return presetBank->getCurrentPreset();
 }
 
 void CapstonePluginAudioProcessor::setCurrentProgram (int index)
 {
+    presetBank->recallPreset (index);
 }
 
 const juce::String CapstonePluginAudioProcessor::getProgramName (int index)
 {
-    return {};
+    return presetBank->getPresetName (index);
 }
 
 void CapstonePluginAudioProcessor::changeProgramName (int index, const juce::String& newName)
 {
+    presetBank->renamePreset (index, newName);
 }
 
 //==============================================================================
@@ -111,16 +125,42 @@ void CapstonePluginAudioProcessor::prepareToPlay (double sampleRate, int samples
     dsp::ProcessSpec spec;
     spec.sampleRate = sampleRate;
     spec.maximumBlockSize = static_cast<juce::uint32> (samplesPerBlock);
-    spec.numChannels = getTotalNumInputChannels();
+    spec.numChannels = static_cast<juce::uint32> (getMainBusNumInputChannels());
     
-    //delayProcessor.prepare(spec);
-    grainProcessor.prepare(spec);
+    effectChain.prepare(spec);
+    updateLatency();
+    update();
 }
 
 void CapstonePluginAudioProcessor::update()
 {
-    //delayProcessor.update(*parameters);
-    grainProcessor.update(*parameters);
+    // morphing between two presets overrides the parameters until the morph is cleared
+    float morph = parameters->getRawParameterValue(PARAMS::PresetMorph)->load() * 0.01f;
+    
+    if (auto* morphed = presetBank->applyMorph(morph))
+        effectChain.update(*morphed);
+    else
+        effectChain.update(*parameters);
+}
+
+// message thread only: the host is told about latency changes outside the audio callback
+void CapstonePluginAudioProcessor::updateLatency()
+{
+    effectChain.applyLatencySettings(*parameters);
+    
+    int latency = effectChain.getLatencySamples();
+    if (latency != getLatencySamples())
+        setLatencySamples(latency);
+}
+
+void CapstonePluginAudioProcessor::parameterChanged (const juce::String&, float)
+{
+    triggerAsyncUpdate();
+}
+
+void CapstonePluginAudioProcessor::handleAsyncUpdate()
+{
+    updateLatency();
 }
 
 void CapstonePluginAudioProcessor::releaseResources()
@@ -148,6 +188,13 @@ bool CapstonePluginAudioProcessor::isBusesLayoutSupported (const BusesLayout& la
    #if ! JucePlugin_IsSynth
     if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
         return false;
+    
+    // the sidechain is optional, hosts may leave it disabled
+    auto sidechain = layouts.getChannelSet (true, 1);
+    if (! sidechain.isDisabled()
+     && sidechain != juce::AudioChannelSet::mono()
+     && sidechain != juce::AudioChannelSet::stereo())
+        return false;
    #endif
 
     return true;
@@ -164,11 +211,19 @@ void CapstonePluginAudioProcessor::processBlock (juce::AudioBuffer<float>& buffe
     auto totalNumInputChannels  = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
 
-    //auto audioBlock = dsp::AudioBlock<float>(buffer);
-    //auto context = dsp::ProcessContextReplacing<float>(audioBlock);
-    //delayProcessor.process(context);
+    // bus buffers refer to the host's channel data, nothing is copied here
+    auto mainBuffer = getBusBuffer (buffer, true, 0);
+    auto* sidechainBus = getBus (true, 1);
     
-    grainProcessor.process(buffer);
+    if (sidechainBus != nullptr && sidechainBus->isEnabled())
+    {
+        auto sidechainBuffer = getBusBuffer (buffer, true, 1);
+        effectChain.process (mainBuffer, &sidechainBuffer);
+    }
+    else
+    {
+        effectChain.process (mainBuffer);
+    }
 }
 
 //==============================================================================
@@ -179,22 +234,46 @@ bool CapstonePluginAudioProcessor::hasEditor() const
 
 juce::AudioProcessorEditor* CapstonePluginAudioProcessor::createEditor()
 {
-    //return new CapstonePluginAudioProcessorEditor (*this);
-    return new GenericAudioProcessorEditor (*this);
+    return new CapstonePluginAudioProcessorEditor (*this);
 }
 
 //==============================================================================
 void CapstonePluginAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
 {
-    // You should use this method to store your parameters in the memory block.
-    // You could do that either as raw data, or use the XML or ValueTree classes
-    // as intermediaries to make it easy to save and load complex data.
+    // binary layout: magic, version, parameters, morph amount, grain seed, the preset bank and
+    // morph pair, then the history if Freeze is holding it
+    juce::MemoryOutputStream stream (destData, false);
+    stream.writeInt (stateMagic);
+    stream.writeCompressedInt (stateVersion);
+    
+    presetBank->writeParameters (stream);
+    
+    // the morph amount drives the bank, so it is saved alongside it rather than in it
+    auto* morph = parameters->getParameter (PARAMS::PresetMorph);
+    stream.writeFloat (morph->convertFrom0to1 (morph->getValue()));
+    stream.writeInt64 (effectChain.get<GrainProcessor>().getSeed());
+    presetBank->writePresets (stream);
+    effectChain.writeHistory (stream);
 }
 
 void CapstonePluginAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
 {
-    // You should use this method to restore your parameters from this memory block,
-    // whose contents will have been created by the getStateInformation() call.
+    juce::MemoryInputStream stream (data, static_cast<size_t> (sizeInBytes), false);
+    
+    if (sizeInBytes < 8 || stream.readInt() != stateMagic)
+        return;
+    
+    if (stream.readCompressedInt() != stateVersion)
+        return;
+    
+    presetBank->readParameters (stream);
+    
+    auto* morph = parameters->getParameter (PARAMS::PresetMorph);
+    morph->setValueNotifyingHost (morph->convertTo0to1 (stream.readFloat()));
+    
+    effectChain.get<GrainProcessor>().setSeed (stream.readInt64());
+    presetBank->readPresets (stream);
+    effectChain.readHistory (stream);
 }
 
 //==============================================================================
@@ -9,12 +9,18 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "EffectChain.h"
+#include "DelayProcessor.h"
 #include "GrainProcessor.h"
+#include "PitchShiftProcessor.h"
+#include "PresetBank.h"
 
 //==============================================================================
 /**
 */
-class CapstonePluginAudioProcessor  : public juce::AudioProcessor
+class CapstonePluginAudioProcessor  : public juce::AudioProcessor,
+                                      private juce::AudioProcessorValueTreeState::Listener,
+                                      private juce::AsyncUpdater
 {
 public:
     //==============================================================================
@@ -38,6 +44,9 @@ public:
     bool hasEditor() const override;
     
     void update();
+    void updateLatency();
+    
+    PresetBank& getPresetBank() { return *presetBank; }
 
     //==============================================================================
     const juce::String getName() const override;
@@ -59,10 +68,17 @@ public:
     void setStateInformation (const void* data, int sizeInBytes) override;
 
 private:
-    //DelayProcessor delayProcessor;
-    GrainProcessor grainProcessor;
+    // parameters that change the reported latency, applied on the message thread
+    void parameterChanged (const juce::String& parameterID, float newValue) override;
+    void handleAsyncUpdate() override;
+    
+    EffectChain<DelayProcessor, GrainProcessor, PitchShiftProcessor> effectChain;
     
     std::unique_ptr<juce::AudioProcessorValueTreeState> parameters;
+    std::unique_ptr<PresetBank> presetBank;
+    
+    static constexpr int stateMagic = 0x43505354; // "CPST"
+    static constexpr int stateVersion = 1;
     
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CapstonePluginAudioProcessor)
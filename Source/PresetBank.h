@@ -0,0 +1,400 @@
+/*
+  ==============================================================================
+
+    PresetBank.h
+    Created: 18 Oct 2026 1:32:05pm
+    Author:  Aidan Stephenson
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <JuceHeader.h>
+#include "ParameterIDs.h"
+using namespace juce;
+
+// denormalised values for every bank parameter, in the order the processor declares them
+struct ParameterSnapshot
+{
+    String name;
+    std::vector<float> values;
+};
+
+// Stands in for AudioProcessorValueTreeState when the chain reads morphed values.
+// Storage is allocated once in prepare, lookups compare ids without allocating.
+class ParameterState
+{
+public:
+    void prepare(const StringArray& ids)
+    {
+        parameterIDs = ids;
+        values = std::make_unique<std::atomic<float>[]>((size_t)ids.size());
+    }
+
+    std::atomic<float>* getRawParameterValue(StringRef parameterID)
+    {
+        int index = parameterIDs.indexOf(parameterID);
+        jassert(index >= 0);
+        return &values[(size_t)index];
+    }
+
+    void set(int index, float value)
+    {
+        values[(size_t)index].store(value, std::memory_order_relaxed);
+    }
+
+private:
+    StringArray parameterIDs;
+    std::unique_ptr<std::atomic<float>[]> values;
+};
+
+// the two presets a morph runs between, published to the audio thread as one pointer
+struct MorphPair
+{
+    const ParameterSnapshot* a;
+    const ParameterSnapshot* b;
+};
+
+/*
+    Presets are captured and recalled on the message thread, through the host's program
+    list or the editor. Morphing between two of them runs on the audio thread: the message
+    thread publishes an immutable MorphPair with a single atomic pointer store, and
+    applyMorph interpolates between its two snapshots once per block into a preallocated
+    ParameterState.
+
+    Recalling a preset first publishes the pair {preset, preset}, so the audio thread runs
+    on the whole preset while the parameters are set one by one, then drops the override
+    once every parameter holds its new value. A block never sees half of a preset.
+
+    A pair that is replaced, and a snapshot that is no longer a preset, is retired with the
+    morph epoch. applyMorph bumps the epoch once on the way in and once on the way out, so an
+    even epoch means it was not reading, and any change of epoch means it has finished the
+    read it was in. Retired objects are deleted on the message thread once either holds.
+*/
+class PresetBank : public ChangeBroadcaster
+{
+public:
+    PresetBank(AudioProcessorValueTreeState& state)
+    {
+        for (auto* param : state.processor.getParameters())
+        {
+            if (auto* ranged = dynamic_cast<RangedAudioParameter*>(param))
+            {
+                // the morph control is what drives the bank, it is never part of a preset
+                if (ranged->getParameterID() == PARAMS::PresetMorph)
+                    continue;
+
+                parameters.add(ranged);
+                parameterIDs.add(ranged->getParameterID());
+            }
+        }
+
+        morphState.prepare(parameterIDs);
+
+        // hosts expect at least one program, start with the defaults
+        capturePreset("Init");
+    }
+
+    // the audio thread has stopped by the time the processor deletes the bank
+    ~PresetBank()
+    {
+        delete morph.exchange(nullptr);
+    }
+
+    int capturePreset(const String& name)
+    {
+        auto snapshot = std::make_unique<ParameterSnapshot>();
+        snapshot->name = name;
+        snapshot->values.reserve((size_t)parameters.size());
+
+        for (auto* param : parameters)
+            snapshot->values.push_back(param->convertFrom0to1(param->getValue()));
+
+        presets.add(snapshot.release());
+        currentPreset = presets.size() - 1;
+        sendChangeMessage();
+
+        return currentPreset;
+    }
+
+    void recallPreset(int index)
+    {
+        if (!isPositiveAndBelow(index, presets.size()))
+            return;
+
+        morphIndexA = morphIndexB = -1;
+        applySnapshot(*presets[index], true);
+        publishMorph();
+
+        currentPreset = index;
+        sendChangeMessage();
+    }
+
+    void renamePreset(int index, const String& name)
+    {
+        if (!isPositiveAndBelow(index, presets.size()))
+            return;
+
+        presets[index]->name = name;
+        sendChangeMessage();
+    }
+
+    void setMorphPresets(int indexA, int indexB)
+    {
+        if (!isPositiveAndBelow(indexA, presets.size()) || !isPositiveAndBelow(indexB, presets.size()))
+            return;
+
+        morphIndexA = indexA;
+        morphIndexB = indexB;
+        publishMorph();
+        sendChangeMessage();
+    }
+
+    void clearMorph()
+    {
+        morphIndexA = morphIndexB = -1;
+        publishMorph();
+        sendChangeMessage();
+    }
+
+    int getNumPresets() const
+    {
+        return presets.size();
+    }
+
+    int getCurrentPreset() const
+    {
+        return currentPreset;
+    }
+
+    // -1 when no morph is set
+    int getMorphPresetA() const
+    {
+        return morphIndexA;
+    }
+
+    int getMorphPresetB() const
+    {
+        return morphIndexB;
+    }
+
+    String getPresetName(int index) const
+    {
+        return isPositiveAndBelow(index, presets.size()) ? presets[index]->name : String();
+    }
+
+    // audio thread: returns nullptr when no morph is set, otherwise the interpolated parameters
+    ParameterState* applyMorph(float amount)
+    {
+        // odd while the pair is in use, see collectGarbage
+        epoch.fetch_add(1);
+        auto* pair = morph.load();
+
+        if (pair == nullptr)
+        {
+            epoch.fetch_add(1);
+            return nullptr;
+        }
+
+        for (int i = 0; i < parameters.size(); i++)
+        {
+            float valueA = pair->a->values[(size_t)i];
+            float valueB = pair->b->values[(size_t)i];
+
+            // bools and choices switch over halfway instead of passing through invalid values
+            if (parameters[i]->isDiscrete())
+                morphState.set(i, amount < 0.5f ? valueA : valueB);
+            else
+                morphState.set(i, valueA + amount * (valueB - valueA));
+        }
+
+        epoch.fetch_add(1);
+        return &morphState;
+    }
+
+    // values are stored denormalised, like the presets, so a changed range keeps the saved setting
+    void writeParameters(OutputStream& stream) const
+    {
+        stream.writeCompressedInt(parameters.size());
+
+        for (auto* param : parameters)
+        {
+            stream.writeString(param->getParameterID());
+            stream.writeFloat(param->convertFrom0to1(param->getValue()));
+        }
+    }
+
+    // parameters are matched by id, so state saved by an older build with fewer parameters still loads.
+    // Loaded values are applied like a recalled preset without the change gestures, as nothing is
+    // being edited. Parameters missing from the stream keep their value
+    void readParameters(InputStream& stream)
+    {
+        auto snapshot = std::make_unique<ParameterSnapshot>();
+        snapshot->values.reserve((size_t)parameters.size());
+
+        for (auto* param : parameters)
+            snapshot->values.push_back(param->convertFrom0to1(param->getValue()));
+
+        int numStored = stream.readCompressedInt();
+
+        for (int i = 0; i < numStored && !stream.isExhausted(); i++)
+        {
+            String parameterID = stream.readString();
+            float value = stream.readFloat();
+
+            int index = parameterIDs.indexOf(parameterID);
+            if (index >= 0)
+                snapshot->values[(size_t)index] = value;
+        }
+
+        applySnapshot(*snapshot, false);
+        publishMorph();
+
+        retire(nullptr, std::move(snapshot));
+    }
+
+    // layout: parameter id table, then every preset as a name and one value per id, then the
+    // current preset and the morph pair (-1 when unset)
+    void writePresets(OutputStream& stream) const
+    {
+        stream.writeCompressedInt(parameterIDs.size());
+        for (auto& parameterID : parameterIDs)
+            stream.writeString(parameterID);
+
+        stream.writeCompressedInt(presets.size());
+        for (auto* preset : presets)
+        {
+            stream.writeString(preset->name);
+            for (auto value : preset->values)
+                stream.writeFloat(value);
+        }
+
+        stream.writeCompressedInt(currentPreset);
+        stream.writeCompressedInt(morphIndexA);
+        stream.writeCompressedInt(morphIndexB);
+    }
+
+    // replaces the bank. Values are matched by id, parameters the stream doesn't know get their default
+    void readPresets(InputStream& stream)
+    {
+        int numStoredIDs = stream.readCompressedInt();
+        Array<int> storedIndex;
+
+        for (int i = 0; i < numStoredIDs && !stream.isExhausted(); i++)
+            storedIndex.add(parameterIDs.indexOf(stream.readString()));
+
+        int numPresets = stream.readCompressedInt();
+        if (stream.isExhausted() || numPresets <= 0)
+            return;
+
+        morphIndexA = morphIndexB = -1;
+        publishMorph();
+
+        while (!presets.isEmpty())
+            retire(nullptr, std::unique_ptr<ParameterSnapshot>(presets.removeAndReturn(presets.size() - 1)));
+
+        for (int p = 0; p < numPresets && !stream.isExhausted(); p++)
+        {
+            auto snapshot = std::make_unique<ParameterSnapshot>();
+            snapshot->name = stream.readString();
+
+            for (auto* param : parameters)
+                snapshot->values.push_back(param->convertFrom0to1(param->getDefaultValue()));
+
+            for (auto index : storedIndex)
+            {
+                float value = stream.readFloat();
+                if (index >= 0)
+                    snapshot->values[(size_t)index] = value;
+            }
+
+            presets.add(snapshot.release());
+        }
+
+        currentPreset = jlimit(0, presets.size() - 1, stream.readCompressedInt());
+        int indexA = stream.readCompressedInt();
+        int indexB = stream.readCompressedInt();
+
+        setMorphPresets(indexA, indexB);
+        sendChangeMessage();
+    }
+
+private:
+    // something the audio thread may still be reading, tagged with the epoch it was retired at
+    struct Retired
+    {
+        std::unique_ptr<MorphPair> pair;
+        std::unique_ptr<ParameterSnapshot> snapshot;
+        uint32 epoch;
+    };
+
+    // audio thread runs on the snapshot while the parameters are set one by one, callers then
+    // publish whichever morph should follow. Gestures are only sent for edits the user made
+    void applySnapshot(const ParameterSnapshot& snapshot, bool asGesture)
+    {
+        publishPair(std::make_unique<MorphPair>(MorphPair { &snapshot, &snapshot }));
+
+        for (int i = 0; i < parameters.size(); i++)
+        {
+            auto* param = parameters[i];
+
+            if (asGesture)
+                param->beginChangeGesture();
+
+            param->setValueNotifyingHost(param->convertTo0to1(snapshot.values[(size_t)i]));
+
+            if (asGesture)
+                param->endChangeGesture();
+        }
+    }
+
+    // publishes the pair set by morphIndexA and morphIndexB, or no morph when they are unset
+    void publishMorph()
+    {
+        if (isPositiveAndBelow(morphIndexA, presets.size()) && isPositiveAndBelow(morphIndexB, presets.size()))
+            publishPair(std::make_unique<MorphPair>(MorphPair { presets[morphIndexA], presets[morphIndexB] }));
+        else
+            publishPair(nullptr);
+    }
+
+    void publishPair(std::unique_ptr<MorphPair> pair)
+    {
+        std::unique_ptr<MorphPair> previous(morph.exchange(pair.release()));
+        retire(std::move(previous), nullptr);
+    }
+
+    // only call once nothing published can reach the objects any more
+    void retire(std::unique_ptr<MorphPair> pair, std::unique_ptr<ParameterSnapshot> snapshot)
+    {
+        if (pair != nullptr || snapshot != nullptr)
+            retired.add(new Retired { std::move(pair), std::move(snapshot), epoch.load() });
+
+        collectGarbage();
+    }
+
+    // an object retired at an even epoch was out of reach before the audio thread's next read
+    // began, one retired at an odd epoch is free once the read in progress has finished
+    void collectGarbage()
+    {
+        const uint32 now = epoch.load();
+
+        for (int i = retired.size(); --i >= 0;)
+            if ((retired[i]->epoch & 1) == 0 || retired[i]->epoch != now)
+                retired.remove(i);
+    }
+
+    Array<RangedAudioParameter*> parameters;
+    StringArray parameterIDs;
+
+    OwnedArray<ParameterSnapshot> presets;
+    OwnedArray<Retired> retired;
+    std::atomic<MorphPair*> morph { nullptr };
+    std::atomic<uint32> epoch { 0 };
+    ParameterState morphState;
+
+    int currentPreset = 0, morphIndexA = -1, morphIndexB = -1;
+};